@@ -13,6 +13,36 @@
 
 namespace madness {
 
+/// energies for the BSH operators of a set of functions, grouped into buckets
+
+/// Functions whose energies differ by at most width (relative to the lowest
+/// energy of the bucket) get the mean energy of their bucket, so they can
+/// share one BSH operator.  The difference to the exact energy must be moved
+/// to the right-hand side, i.e. (T - e_b) psi = -(V - (e - e_b)) psi, which
+/// leaves the solution unchanged.
+/// @param[in]	eps		energies, all negative
+/// @param[in]	width	relative width of a bucket; 0 leaves the energies unchanged
+/// @return		the energies, one per function
+inline Tensor<double> bucket_bsh_energies(const Tensor<double>& eps, const double width) {
+	Tensor<double> result=copy(eps);
+	if (width<=0.0) return result;
+	const long n=eps.size();
+	std::vector<long> order(n);
+	for (long i=0; i<n; ++i) order[i]=i;
+	std::sort(order.begin(),order.end(),[&eps](long i, long j) {return eps(i)<eps(j);});
+
+	for (long first=0; first<n; ) {
+		const double e0=eps(order[first]);
+		long last=first;
+		double mean=0.0;
+		while (last<n and std::abs(eps(order[last])-e0)<=width*std::abs(e0)) mean+=eps(order[last++]);
+		mean/=double(last-first);
+		for (long i=first; i<last; ++i) result(order[i])=mean;
+		first=last;
+	}
+	return result;
+}
+
 /// apply the BSH operator on a vector of functions with corresponding potentials
 
 /// TODO: adding a level shift seems to make the operation less precise, why??
@@ -27,6 +57,7 @@ public:
 	bool printme=false;
 	bool destroy_Vpsi=false;
 	bool do_coupling=false;
+	double bucket_width=0.0;	///< functions with energies within this relative width share one operator
 	Function<double,NDIM> metric;
 
 public:
@@ -56,13 +87,20 @@ public:
 		// no coupling means F_{ij} =\eps_i \delta_{ij}, and the coupling term vanishes
 		Vpsi-=add_coupling_and_levelshift(psi,eps);
 
-	    std::vector < std::shared_ptr<SeparatedConvolution<double,NDIM> > > ops(psi.size());
+	    // functions with the same energy share the operator and its caches
+	    typedef std::shared_ptr<SeparatedConvolution<double,NDIM> > poperatorT;
+	    const Tensor<double> e_green=green_energies(eps);
+	    std::map<double,poperatorT> bucket_ops;
+	    std::vector<poperatorT> ops(psi.size());
 	    for (int i=0; i<eps.dim(0); ++i) {
-	    	T e_i= (eps.ndim()==2) ? eps(i,i) : eps(i);
-	    	ops[i]=std::shared_ptr<SeparatedConvolution<double,NDIM> >(
-	    			BSHOperatorPtr<NDIM>(world, sqrt(-2.0*eps_in_green(e_i)), lo, bshtol));
-	    	ops[i]->destructive()=true;
+	    	poperatorT& op=bucket_ops[e_green(i)];
+	    	if (not op) {
+	    		op=poperatorT(BSHOperatorPtr<NDIM>(world, sqrt(-2.0*e_green(i)), lo, bshtol));
+	    		op->destructive()=true;
+	    	}
+	    	ops[i]=op;
 	    }
+	    if (printme) print("number of BSH operators",bucket_ops.size());
 
 	    const std::vector<Function<T,NDIM> > tmp = apply(world,ops,-2.0*Vpsi);
 	    const std::vector<Function<T,NDIM> > res=truncate(psi-tmp,FunctionDefaults<NDIM>::get_thresh()*0.1);
@@ -117,6 +155,15 @@ public:
 		return std::min(-0.05,std::real(eps)+levelshift);
 	}
 
+	/// the energies entering the Green's functions, in buckets of bucket_width
+
+	/// @param[in]	eps		orbital energies or the square fock matrix
+	Tensor<double> green_energies(const Tensor<T>& eps) const {
+		Tensor<double> e(eps.dim(0));
+		for (int i=0; i<eps.dim(0); ++i) e(i)=eps_in_green((eps.ndim()==2) ? eps(i,i) : eps(i));
+		return bucket_bsh_energies(e,bucket_width);
+	}
+
 	std::vector<Function<T,NDIM> > add_coupling_and_levelshift(const std::vector<Function<T,NDIM> > psi,
 			const Tensor<T> fock1) const {
 
@@ -136,19 +183,20 @@ public:
 		// ( T - fock(i,i) ) psi_i  = -V psi_i + \sum_{j\neq i} psi_j fock(j,i)
 		// if there is no level shift and the orbital energies are large enough the
 		// diagonal should simply vanish.
+		const Tensor<double> e_green=green_energies(fock1);
 		if (do_coupling) {
 			Tensor<T> fock=copy(fock1);
 			for (int i=0; i<fock.dim(0); ++i) {
-				fock(i,i)-=eps_in_green(fock(i,i));
+				fock(i,i)-=e_green(i);
 			}
 			return transform(world, psi, fock);
 
 		} else  {
 			std::vector<T> eps(psi.size());
 			if (fock1.ndim()==1)
-				for (int i=0; i<fock1.dim(0); ++i) eps[i]=fock1(i)-eps_in_green(fock1(i));
+				for (int i=0; i<fock1.dim(0); ++i) eps[i]=fock1(i)-e_green(i);
 			if (fock1.ndim()==2)
-				for (int i=0; i<fock1.dim(0); ++i) eps[i]=fock1(i,i)-eps_in_green(fock1(i,i));
+				for (int i=0; i<fock1.dim(0); ++i) eps[i]=fock1(i,i)-e_green(i);
 
 			std::vector<Function<T,NDIM> > result=copy(world,psi);
 			scale(world,result,eps);
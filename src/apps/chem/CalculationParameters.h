@@ -92,11 +92,17 @@ struct CalculationParameters : public QCCalculationParametersBase {
 		initialize<bool>  ("no_orient",false,"if true the molecule coordinates will not be reoriented");
 		initialize<bool>  ("save",true,"if true save orbitals to disk");
 		initialize<int>   ("maxsub",10,"size of iterative subspace ... set to 0 or 1 to disable");
+		initialize<bool>  ("ace",false,"use the adaptively compressed exchange operator between full rebuilds");
+		initialize<double>("ace_thresh",1.e-3,"rebuild the ACE projector if the density changes more than this");
+		initialize<int>   ("incremental_fock",0,"build the Coulomb potential from density differences, full rebuild every n iterations (0: off)");
+		initialize<double>("incremental_fock_truncate",10.0,"truncate density differences at this multiple of the threshold");
+		initialize<double>("bsh_bucket_width",0.0,"orbitals with energies within this relative width share one BSH operator (0: off)");
 		initialize<double> ("orbitalshift",0.0,"scf orbital shift: shift the occ orbitals to lower energies");
 		initialize<int>    ("npt_plot",101,"no. of points to use in each dim for plots");
 //		initialize<Tensor<double> > ("plot_cell",Tensor<double>(),"lo hi in each dimension for plotting (default is all space)");
 		initialize<std::vector<double> > ("plot_cell",std::vector<double>(),"lo hi in each dimension for plotting (default is all space)");
 		initialize<std::string> ("aobasis","6-31g","AO basis used for initial guess (6-31g or sto-3g)");
+		initialize<double> ("guess_thresh",1.e-2,"make the initial guess at this threshold and project it to the first protocol step (off if not looser than that)");
 		initialize<std::string> ("core_type","none","core potential type",{"none","mpc"});
 		initialize<bool> ("derivatives",false,"if true calculate nuclear derivatives");
 		initialize<bool> ("dipole",false,"if true calculate dipole moment");
@@ -212,6 +218,7 @@ struct CalculationParameters : public QCCalculationParametersBase {
 	std::string xc() const {return get<std::string>("xc");}
 
 	std::string aobasis() const {return get<std::string>("aobasis");}
+	double guess_thresh() const {return get<double>("guess_thresh");}
 	std::string core_type() const {return get<std::string>("core_type");}
 	bool psp_calc() const {return get<bool>("psp_calc");}
 	bool pure_ae() const {return get<bool>("pure_ae");}
@@ -223,6 +230,11 @@ struct CalculationParameters : public QCCalculationParametersBase {
 	bool restart_cphf() const {return get<bool>("restart_cphf");}
 
 	int maxsub() const {return get<int>("maxsub");}
+	bool ace() const {return get<bool>("ace");}
+	double ace_thresh() const {return get<double>("ace_thresh");}
+	int incremental_fock() const {return get<int>("incremental_fock");}
+	double incremental_fock_truncate() const {return get<double>("incremental_fock_truncate");}
+	double bsh_bucket_width() const {return get<double>("bsh_bucket_width");}
 	double maxrotn() const {return get<double>("maxrotn");}
 
 	int vnucextra() const {return get<int>("vnucextra");}
@@ -2634,6 +2634,10 @@ PNOPairs PNO::load_pnos(PNOPairs& pairs) const {
 }
 
 void PNO::update_fluctuation_potentials(PNOPairs& pairs) const {
+	if (param.macrotask() and pairs.type == MP2_PAIRTYPE and not param.f12()) {
+		update_fluctuation_potentials_macrotask(pairs);
+		return;
+	}
 	TIMER(timer);
 	PAIRLOOP(it)
 	{
@@ -2650,6 +2654,67 @@ void PNO::update_fluctuation_potentials(PNOPairs& pairs) const {
 	timer.stop().print("Fluctuation Potentials");
 }
 
+void PNO::update_fluctuation_potentials_macrotask(PNOPairs& pairs) const {
+	TIMER(timer);
+	// flatten the PNOs of all active pairs, (i,j) and (j,i) for off-diagonal pairs
+	vector_real_function_3d pno;
+	std::vector<std::pair<long,long> > entries;
+	PAIRLOOP(it)
+	{
+		if (pairs.frozen_ij[it.ij()]) {
+			msg << pairs.name(it) << " is frozen: potential not computed\n";
+			continue;
+		}
+		const vector_real_function_3d& pno_ij=pairs.pno_ij[it.ij()];
+		for (const auto& a : pno_ij) {
+			pno.push_back(a);
+			entries.push_back(std::make_pair(it.i(),it.j()));
+		}
+		if (it.diagonal()) continue;
+		for (const auto& a : pno_ij) {
+			pno.push_back(a);
+			entries.push_back(std::make_pair(it.j(),it.i()));
+		}
+	}
+	if (pno.empty()) return;
+
+	Tensor<long> ij(pno.size(),2);
+	for (std::size_t a=0; a<entries.size(); ++a) {
+		ij(a,0)=entries[a].first;
+		ij(a,1)=entries[a].second;
+	}
+
+	// the cost of applying the Coulomb operator scales with the number of boxes
+	std::vector<double> cost(pno.size());
+	for (std::size_t a=0; a<pno.size(); ++a) cost[a]=pno[a].get_impl()->get_coeffs().size();
+	world.gop.sum(cost.data(),cost.size());
+
+	MacroTaskFluctuationPotential task(cost, nemo.get_calc()->param.lo(), param.op_thresh(), param.thresh());
+	auto taskq=std::shared_ptr<MacroTaskQ>(new MacroTaskQ(world, world.size()));
+	MacroTask mtask(world, task, taskq);
+	vector_real_function_3d W=mtask(pno, ij, f12.acmos, nemo.get_calc()->amo);
+	taskq->run_all();
+	truncate(world, W, param.thresh());
+
+	// distribute the potentials back to the pairs, in the order of the flattening
+	std::size_t a=0;
+	PAIRLOOP(it)
+	{
+		if (pairs.frozen_ij[it.ij()]) continue;
+		const std::size_t rank=pairs.pno_ij[it.ij()].size();
+		pairs.W_ij_i[it.ij()]=vector_real_function_3d(W.begin()+a,W.begin()+a+rank);
+		a+=rank;
+		if (it.diagonal()) {
+			pairs.W_ij_j[it.ij()]=pairs.W_ij_i[it.ij()];
+		} else {
+			pairs.W_ij_j[it.ij()]=vector_real_function_3d(W.begin()+a,W.begin()+a+rank);
+			a+=rank;
+		}
+	}
+	MADNESS_ASSERT(a==W.size());
+	timer.stop().print("Fluctuation Potentials (macrotask)");
+}
+
 /// the terms are expanded as follows:
 /// Q (-J1 +K1) | i(1) >  < a(2) | j(2) >
 ///  +  Q | i(1) > < a(2) | -J(2) + K(2) | j(2) >
@@ -14,6 +14,7 @@
 
 #include <chem/PNOF12Potentials.h>
 #include <madness/world/worldmem.h>
+#include <madness/mra/macrotaskq.h>
 
 #include <chem/CC2.h>
 #include <chem/molecule.h>
@@ -23,6 +24,89 @@ namespace madness {
 // needed to plot cubefiles with madness
 extern std::vector<std::string> cubefile_header(std::string filename="input", const bool& no_orient=false);
 
+/// MacroTask for the MP2 fluctuation potentials Q(i * g(j*a)) of all pairs
+
+/// The PNOs a of all pairs are flattened into one vector, together with a table
+/// of the (active) orbital indices (i,j) of every entry; an off-diagonal pair
+/// enters twice, as (i,j) and as (j,i).  The entries are batched by their
+/// estimated cost, so that a subworld gets a few large pairs or many small ones.
+class MacroTaskFluctuationPotential : public MacroTaskOperationBase {
+
+	/// contiguous batches of about equal cost
+	class MacroTaskPartitionerCost : public MacroTaskPartitioner {
+	public:
+		std::vector<double> cost;   ///< estimated cost of every entry
+
+		MacroTaskPartitionerCost(const std::vector<double>& cost) : cost(cost) {
+			max_batch_size=30;
+			min_batch_size=1;
+		}
+
+		partitionT do_partitioning(const std::size_t& vsize1, const std::size_t& vsize2,
+				const std::string policy) const override {
+			MADNESS_CHECK(cost.size()==vsize1);
+			const double total=std::accumulate(cost.begin(),cost.end(),0.0);
+			// a few batches per subworld for load balance
+			const double target=total/double(4*nsubworld);
+			partitionT result;
+			std::size_t begin=0;
+			while (begin<vsize1) {
+				std::size_t end=begin;
+				double batchcost=0.0;
+				while (end<vsize1 and end-begin<max_batch_size
+						and (end-begin<min_batch_size or batchcost+cost[end]<=target)) {
+					batchcost+=cost[end++];
+				}
+				Batch batch(Batch_1D(begin,end),Batch_1D(begin,end));
+				result.push_back(std::make_pair(batch,batchcost));
+				begin=end;
+			}
+			return result;
+		}
+	};
+
+	double lo=1.e-4;
+	double op_thresh=1.e-6;
+	double thresh=1.e-3;
+
+public:
+	MacroTaskFluctuationPotential(const std::vector<double>& cost, const double lo,
+			const double op_thresh, const double thresh)
+		: lo(lo), op_thresh(op_thresh), thresh(thresh) {
+		partitioner.reset(new MacroTaskPartitionerCost(cost));
+	}
+
+	typedef std::tuple<const vector_real_function_3d&, const Tensor<long>&,
+			const vector_real_function_3d&, const vector_real_function_3d&> argtupleT;
+
+	using resultT = vector_real_function_3d;
+
+	resultT allocator(World& world, const argtupleT& argtuple) const {
+		return zero_functions_compressed<double,3>(world, std::get<0>(argtuple).size());
+	}
+
+	/// @param[in]	pno		the flattened PNOs (batched)
+	/// @param[in]	ij		(nentry,2) active orbital indices i and j of every entry
+	/// @param[in]	acmos	the active orbitals
+	/// @param[in]	amo		all occupied orbitals, for the projector Q
+	resultT operator()(const vector_real_function_3d& pno, const Tensor<long>& ij,
+			const vector_real_function_3d& acmos, const vector_real_function_3d& amo) const {
+		World& world=pno.front().world();
+		const long begin=batch.input[0].is_full_size() ? 0 : batch.input[0].begin;
+		auto poisson=std::shared_ptr<real_convolution_3d>(CoulombOperatorPtr(world, lo, op_thresh));
+		QProjector<double,3> Q(world, amo);
+
+		vector_real_function_3d aj(pno.size());
+		for (std::size_t a=0; a<pno.size(); ++a) aj[a]=acmos[ij(begin+a,1)]*pno[a];
+		vector_real_function_3d gaj=apply(world, *poisson, aj);
+		vector_real_function_3d Vaj_i(pno.size());
+		for (std::size_t a=0; a<pno.size(); ++a) Vaj_i[a]=acmos[ij(begin+a,0)]*gaj[a];
+		Vaj_i=Q(Vaj_i);
+		truncate(world, Vaj_i, thresh);
+		return Vaj_i;
+	}
+};
+
 class PNO {
 public:
 	typedef std::shared_ptr<operatorT> poperatorT;
@@ -129,6 +213,8 @@ public:
 
 	/// compute all fluctuation potentials and store them in the pair structure
 	void update_fluctuation_potentials(PNOPairs& pairs) const;
+	/// compute the MP2 fluctuation potentials of all pairs that are not frozen as MacroTasks in subworlds
+	void update_fluctuation_potentials_macrotask(PNOPairs& pairs) const;
 	/// Compute the MP2 fluctuation potential of a speficif pair
 	PNOPairs compute_fluctuation_potential(const ElectronPairIterator& it, PNOPairs& pairs) const;
 	/// Compute the CIS(D) fluctuation potential of a specific pair
@@ -97,6 +97,7 @@ public:
 		initialize<std::string>("exchange", "full", "approximate exchange with 'neglect' or xc functional -> same syntax as moldft");
 		initialize<bool>("save_pnos",true, "Save the OBS-PNOs to a file, before and after orthonormalization.");
 		initialize<bool>("diagonal", false, "Compute only diagonal PNOs");
+		initialize<bool>("macrotask", false, "compute the MP2 fluctuation potentials (without f12) as macrotasks in subworlds, batched by the cost of the pairs");
 	}
 
 	void set_derived_values(const Molecule& molecule) {
@@ -148,6 +149,7 @@ public:
 		return result;
 	}
 	bool diagonal()const {return get<bool>("diagonal");}
+	bool macrotask()const {return get<bool>("macrotask");}
 	bool save_pnos()const { return get<bool >("save_pnos");}
 	std::string exchange()const {return get<std::string>("exchange");}
 	bool exop_trigo()const { return get<bool >("exop_trigo");}
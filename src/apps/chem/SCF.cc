@@ -43,8 +43,10 @@
 #include <madness/mra/qmprop.h>
 #include <chem/nemo.h>
 #include <chem/SCFOperators.h>
+#include <chem/exchangeoperator.h>
 #include <madness/world/worldmem.h>
 #include <chem/projector.h>
+#include <chem/BSHApply.h>
 
 namespace madness {
 
@@ -1047,6 +1049,40 @@ bool SCF::restart_aos(World& world) {
 	return true;
 }
 
+/// Make the initial guess at the threshold guess_thresh and project the orbitals to the current threshold
+
+/// Projecting the ao basis, the guess potential and the fock matrix are the
+/// bulk of the cost of the guess, and they are much cheaper at a loose
+/// threshold.  The guess orbitals are projected to the current
+/// threshold, which must be the first step of the protocol.  Without a
+/// looser guess_thresh this is the guess at the current threshold.
+void SCF::multilevel_initial_guess(World & world) {
+	PROFILE_MEMBER_FUNC(SCF);
+	START_TIMER(world);
+	const double thresh=FunctionDefaults<3>::get_thresh();
+	const bool multilevel=(param.guess_thresh()>thresh) and (param.nwfile()=="none");
+	if (multilevel) {
+		if (world.rank()==0 and param.print_level()>2)
+			print("making the initial guess at thresh",param.guess_thresh());
+		set_protocol<3>(world,param.guess_thresh());
+	}
+
+	START_TIMER(world);
+	reset_aobasis(param.aobasis());
+	ao=project_ao_basis(world,aobasis);
+	END_TIMER(world, "guess project aos");
+	make_nuclear_potential(world);
+	initial_guess(world);
+
+	if (multilevel) {
+		START_TIMER(world);
+		set_protocol<3>(world,thresh);
+		project(world);
+		END_TIMER(world, "guess project mos");
+	}
+	END_TIMER(world, "guess total");
+}
+
 void SCF::initial_guess(World & world) {
 	PROFILE_MEMBER_FUNC(SCF);
 	START_TIMER(world);
@@ -1579,6 +1615,7 @@ std::vector<poperatorT> SCF::make_bsh_operators(World& world, const tensorT& eva
 	PROFILE_MEMBER_FUNC(SCF);
 	int nmo = evals.dim(0);
 	std::vector < poperatorT > ops(nmo);
+	std::map<double, poperatorT> eps_ops;	// orbitals with equal energies share the operator
 	double tol = FunctionDefaults < 3 > ::get_thresh();
 	for (int i = 0; i < nmo; ++i) {
 		double eps = evals(i);
@@ -1589,9 +1626,13 @@ std::vector<poperatorT> SCF::make_bsh_operators(World& world, const tensorT& eva
 			eps = -0.1;
 		}
 
-		ops[i] = poperatorT(
+		poperatorT& op = eps_ops[eps];
+		if (not op) op = poperatorT(
 				BSHOperatorPtr3D(world, sqrt(-2.0 * eps), param.lo(), tol));
+		ops[i] = op;
 	}
+	if (world.rank() == 0 and (param.print_level()>3))
+		print("number of BSH operators", eps_ops.size());
 
 	return ops;
 }
@@ -1743,6 +1784,11 @@ vecfuncT SCF::apply_potential(World & world, const tensorT & occ,
 		START_TIMER(world);
 		//            vecfuncT Kamo = apply_hf_exchange(world, occ, amo, amo);
 		Exchange<double,3> K=Exchange<double,3>(world,this,ispin).set_symmetric(true);
+		if (param.ace()) {
+			if (not ace_projector[ispin])
+				ace_projector[ispin]=Exchange<double,3>::make_ace_projector(param.ace_thresh());
+			K.set_ace(ace_projector[ispin]);
+		}
 		vecfuncT Kamo=K(amo);
 		tensorT excv = inner(world, Kamo, amo);
 		double exchf = 0.0;
@@ -1920,11 +1966,12 @@ vecfuncT SCF::compute_residual(World & world, tensorT & occ, tensorT & fock,
 	double trantol = vtol / std::min(30.0, double(psi.size()));
 	int nmo = psi.size();
 
+	// the shift fock(i,i)-eps(i) is applied to the rhs, so orbitals
+	// may share the BSH operator of a bucket of similar energies
 	tensorT eps(nmo);
-	for (int i = 0; i < nmo; ++i) {
-		eps(i) = std::min(-0.05, fock(i, i));
-		fock(i, i) -= eps(i);
-	}
+	for (int i = 0; i < nmo; ++i) eps(i) = std::min(-0.05, fock(i, i));
+	eps = bucket_bsh_energies(eps, param.bsh_bucket_width());
+	for (int i = 0; i < nmo; ++i) fock(i, i) -= eps(i);
 	vecfuncT fpsi = transform(world, psi, fock, trantol, true);
 
 	for (int i = 0; i < nmo; ++i) { // Undo the damage
@@ -2744,6 +2791,7 @@ void SCF::iterate_trotter(World& world, Convolution1D<double_complex>* G,
 void SCF::solve(World & world) {
 	PROFILE_MEMBER_FUNC(SCF);
 	functionT arho_old, brho_old;
+	functionT rho_coulomb, vcoul_cached;	// density and Coulomb potential of the last build
 	const double dconv = std::max(FunctionDefaults < 3 > ::get_thresh(),
 			param.dconv());
 	const double trantol = vtol / std::min(30.0, double(amo.size()));
@@ -2821,7 +2869,8 @@ void SCF::solve(World & world) {
 		END_TIMER(world, "Make densities");
 		print_meminfo(world.rank(), "Make densities");
 
-		if (iter < 2 || (iter % 10) == 0) {
+		const bool do_loadbal=(iter < 2 || (iter % 10) == 0);
+		if (do_loadbal) {
 			START_TIMER(world);
 			loadbal(world, arho, brho, arho_old, brho_old, subspace);
 			END_TIMER(world, "Load balancing");
@@ -2854,10 +2903,29 @@ void SCF::solve(World & world) {
 		double enuclear = inner(rho, vnuc);
 		END_TIMER(world, "Nuclear energy");
 
+		// incremental Coulomb build: apply the Coulomb operator on the density difference only.
+		// The cached potential lives in the old process map, so rebuild after load balancing.
 		START_TIMER(world);
-		functionT vcoul = apply(*coulop, rho);
+		const int nrebuild=param.incremental_fock();
+		const bool incremental=(nrebuild>0) and (not do_loadbal) and (iter % nrebuild != 0)
+				and rho_coulomb.is_initialized();
+		functionT vcoul;
+		if (incremental) {
+			functionT drho = rho - rho_coulomb;
+			drho.truncate(param.incremental_fock_truncate()*FunctionDefaults<3>::get_thresh());
+			vcoul = vcoul_cached + apply(*coulop, drho);
+			vcoul.truncate();
+		} else {
+			vcoul = apply(*coulop, rho);
+			// rebuild the exchange operator along with the Coulomb potential
+			if (nrebuild>0) for (auto& ace : ace_projector) if (ace) ace->clear();
+		}
+		if (nrebuild>0) {
+			rho_coulomb = rho;
+			vcoul_cached = vcoul;
+		}
 		functionT vlocal;
-		END_TIMER(world, "Coulomb");
+		END_TIMER(world, incremental ? "Coulomb (incremental)" : "Coulomb");
 		print_meminfo(world.rank(), "Coulomb");
 
 		double ecoulomb = 0.5 * inner(rho, vcoul);
@@ -91,6 +91,17 @@ extern distmatT distributed_localize_PM(World & world,
 		const bool randomize = true,
 		const bool doprint = false);
 
+extern distmatT distributed_localize_PM(World & world,
+		const distmatT & dC,
+		const tensorT & S,
+		const std::vector<int> & set,
+		const std::vector<int> & at_to_bf,
+		const std::vector<int> & at_nbf,
+		const double thresh = 1e-9,
+		const double thetamax = 0.5,
+		const bool randomize = true,
+		const bool doprint = false);
+
 
 inline double mask1(double x) {
 	/* Iterated first beta function to switch smoothly
@@ -342,6 +353,10 @@ public:
 	tensorT aeps, beps;
 	poperatorT coulop;
 	std::vector< std::shared_ptr<real_derivative_3d> > gradop;
+
+	/// ACE projectors for the alpha and beta exchange operator, reused over the iterations
+	std::vector<std::shared_ptr<Exchange<double,3>::ACEProjector> > ace_projector
+		=std::vector<std::shared_ptr<Exchange<double,3>::ACEProjector> >(2);
 	double vtol;
 	double current_energy;
 	//double esol;//etot;
@@ -515,6 +530,8 @@ public:
 
 	void initial_guess(World & world);
 
+	void multilevel_initial_guess(World & world);
+
 	void initial_load_bal(World & world);
 
 	functionT make_density(World & world, const tensorT & occ, const vecfuncT & v) const;
@@ -792,12 +809,7 @@ public:
 			have_initial_guess=calc.restart_aos(world);
 		}
 
-		if (not have_initial_guess) {
-			calc.reset_aobasis(calc.param.aobasis());
-			calc.ao=calc.project_ao_basis(world,calc.aobasis);
-			calc.make_nuclear_potential(world);
-			calc.initial_guess(world);
-		}
+		if (not have_initial_guess) calc.multilevel_initial_guess(world);
 
 		// The below is missing convergence test logic, etc.
 
@@ -858,7 +870,11 @@ public:
                     // Only do this if not starting from NWChem.
                     // analysis will be done on NWChem orbitals.
 
-				if (calc.param.aobasis() != "sto-3g" && calc.param.nwfile() == "none") {
+				// the aos of a sto-3g guess may have been made at the guess threshold
+				const bool ao_current=(calc.param.aobasis()=="sto-3g") and (calc.ao.size()>0)
+						and (calc.ao[0].k()==FunctionDefaults<3>::get_k())
+						and (calc.ao[0].thresh()==FunctionDefaults<3>::get_thresh());
+				if (not ao_current && calc.param.nwfile() == "none") {
 					calc.reset_aobasis("sto-3g");
 					calc.ao=calc.project_ao_basis(world,calc.aobasis);
 				}
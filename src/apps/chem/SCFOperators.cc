@@ -691,6 +691,18 @@ Exchange<T,NDIM>& Exchange<T,NDIM>::set_parameters(const vecfuncT& bra, const ve
     return *this;
 }
 
+template<typename T, std::size_t NDIM>
+Exchange<T,NDIM>& Exchange<T,NDIM>::set_ace(std::shared_ptr<ACEProjector> ace) {
+    impl->set_ace(ace);
+    return *this;
+}
+
+template<typename T, std::size_t NDIM>
+std::shared_ptr<typename Exchange<T,NDIM>::ACEProjector>
+Exchange<T,NDIM>::make_ace_projector(const double rebuild_thresh) {
+    return std::make_shared<ACEProjector>(rebuild_thresh);
+}
+
 template<typename T, std::size_t NDIM>
 bool Exchange<T,NDIM>::is_symmetric() const {
     return impl->is_symmetric();
@@ -104,6 +104,7 @@ class Exchange : public SCFOperatorBase<T,NDIM> {
 public:
 
     class ExchangeImpl;
+    class ACEProjector;
     using implT = std::shared_ptr<ExchangeImpl>;
     typedef Function<T,NDIM> functionT;
     typedef std::vector<functionT> vecfuncT;
@@ -144,6 +145,20 @@ public:
 
     Exchange& set_parameters(const vecfuncT& bra, const vecfuncT& ket, const double lo1);
 
+    /// use the adaptively compressed exchange (ACE) representation of this operator
+
+    /// the projector is built from one full application of K and reused for all following
+    /// applications until it is invalidated. The projector may be shared between several
+    /// exchange operators, e.g. over the SCF iterations.
+    /// @param[in]  ace     the (possibly empty) projector, a null pointer switches ACE off
+    Exchange& set_ace(std::shared_ptr<ACEProjector> ace);
+
+    /// make an empty ACE projector
+
+    /// @param[in]  rebuild_thresh  rebuild the projector if the density or the argument space
+    ///                             have changed by more than this threshold
+    static std::shared_ptr<ACEProjector> make_ace_projector(const double rebuild_thresh);
+
     Function<T, NDIM> operator()(const Function<T, NDIM>& ket) const {
         vecfuncT vket(1, ket);
         vecfuncT vKket = this->operator()(vket);
@@ -136,6 +136,17 @@ public:
     }
 };
 
+// Pipek-Mezey localization by Jacobi rotations of pairs of orbitals
+//
+// Each row of A holds an orbital i as [ C[i,...], U[i,...], Q[i,...] ], where
+// Q[i,a] is its population on atom a.  The populations are updated with each
+// rotation, so only the populations q_ij(a) of the pair have to be computed,
+// and only on the atoms where one of the two orbitals has a population; pairs
+// whose populations do not overlap, i.e. orbitals far apart, are skipped.
+// The threshold on the rotation angle follows the largest angle of the last
+// sweep, so the sweeps profit from the quadratic convergence of the Jacobi
+// method near the solution instead of shrinking the threshold by a fixed
+// factor.
 class SystolicPMOrbitalLocalize : public SystolicMatrixAlgorithm<double> {
     const std::vector<int>& set;
     const std::vector<int>& at_to_bf;
@@ -149,50 +160,41 @@ class SystolicPMOrbitalLocalize : public SystolicMatrixAlgorithm<double> {
     const int nmo;
     int iter;
     AtomicInt ndone_iter;
+    double maxtheta_iter;   // largest rotation angle of this sweep
+    Mutex maxtheta_mutex;
 
 
     // Applies rotation between orbitals i and j for Pipek Mezy
     void localize_PM_ij(const int seti, const int setj,
                         double * MADNESS_RESTRICT Ci, double * MADNESS_RESTRICT Cj,
-                        double * MADNESS_RESTRICT Ui, double * MADNESS_RESTRICT Uj)
+                        double * MADNESS_RESTRICT Ui, double * MADNESS_RESTRICT Uj,
+                        double * MADNESS_RESTRICT Qi, double * MADNESS_RESTRICT Qj)
     {
         if(seti == setj){
-            std::vector<double> Qi(natom), Qj(natom);
             double ovij = 0.0;
-            for(long a = 0; a < natom; ++a) {
-                Qi[a] = PM_q(Svec[a], Ci, Ci, at_to_bf[a], at_nbf[a]);
-                Qj[a] = PM_q(Svec[a], Cj, Cj, at_to_bf[a], at_nbf[a]);
-                ovij += fabs(Qi[a] * Qj[a]);
-            }
+            for(long a = 0; a < natom; ++a) ovij += fabs(Qi[a] * Qj[a]);
 
             if(ovij > tol * tol){
+                // atoms without population of i or j contribute at most natom*qtol^2 to aij and bij
+                const double qtol = 0.1 * tol;
+                std::vector<double> Qij(natom, 0.0);
                 double aij = 0.0;
                 double bij = 0.0;
                 for(long a = 0;a < natom;++a){
                     double qiia = Qi[a];
-                    double qija = PM_q(Svec[a], Ci, Cj, at_to_bf[a], at_nbf[a]);
                     double qjja = Qj[a];
+                    if (fabs(qiia) + fabs(qjja) < qtol) continue;
+                    double qija = PM_q(Svec[a], Ci, Cj, at_to_bf[a], at_nbf[a]);
+                    Qij[a] = qija;
                     double d = qiia - qjja;
                     aij += qija * qija - 0.25 * d * d;
                     bij += qija * d;
                 }
 
-		// double theta = 0.25*bij/aij; // initial estimate for step restriction
-		// if (theta > thetamax) {
-		//   theta = thetamax;
-		// }
-		// else if (theta < -thetamax) {
-		//   theta = -thetamax;
-		// }
-		// else {
-		//   theta = 0.25*atan(bij/aij);
-		// }
-
 		double theta, fa=fabs(aij), fb=fabs(bij), r=fb/aij;
 		// Full formula loses accuracy for b<<a. use taylor series instead
 		if (fb < 1e-2*fa) {
                     theta = -0.25*r*(1.0 - r*r/3.0 + r*r*r*r/5.0);
-                    //theta = -0.25*fabs(bij)/aij;
 		}
 		else {
 		  theta = 0.25 * acos(-aij / sqrt(aij * aij + bij * bij));
@@ -205,17 +207,23 @@ class SystolicPMOrbitalLocalize : public SystolicMatrixAlgorithm<double> {
                 else if(theta < -thetamax)
 		    theta = -thetamax;
 
+                if (fabs(theta) > maxtheta_iter) {
+                    ScopedMutex<Mutex> lock(maxtheta_mutex);
+                    maxtheta_iter = std::max(maxtheta_iter, fabs(theta));
+                }
+
 		if(fabs(theta) >= tol){
-		    //print(theta, aij, bij);
 		    ndone_iter++;
                     double c = cos(theta);
                     double s = sin(theta);
                     drot(nao, Ci, Cj, s, c, 1);
                     drot(nmo, Ui, Uj, s, c, 1);
-                    // for(long a = 0;a < natom;++a){
-                    //     Qi[a] = PM_q(Svec[a], Ci, Ci, at_to_bf[a], at_nbf[a]);
-                    //     Qj[a] = PM_q(Svec[a], Cj, Cj, at_to_bf[a], at_nbf[a]);
-                    // }
+                    for(long a = 0;a < natom;++a){
+                        double qiia = Qi[a];
+                        double qjja = Qj[a];
+                        Qi[a] = c*c*qiia + s*s*qjja - 2.0*c*s*Qij[a];
+                        Qj[a] = c*c*qjja + s*s*qiia + 2.0*c*s*Qij[a];
+                    }
                 }
             }
         }
@@ -247,20 +255,20 @@ public:
           natom(natom),
           nao(nao),
           nmo(nmo),
-          iter(-1)
+          iter(-1),
+          maxtheta_iter(0.0)
     {
         MADNESS_ASSERT(A.is_column_distributed());
         MADNESS_ASSERT(A.coldim() == nmo);
-        MADNESS_ASSERT(A.rowdim() == nao + nmo);
+        MADNESS_ASSERT(A.rowdim() == nao + nmo + natom);
     }
 
     void start_iteration_hook(const TaskThreadEnv& env) {
         if (env.id() == 0) {
             iter++;
-            //if (iter > 0) tol = std::max(0.1 * std::min(maxtheta, tol), thresh);
-            if (iter > 0) tol = std::max(0.333 * tol, thresh);
+            if (iter > 0) tol = std::max(std::min(0.333 * tol, maxtheta_iter * maxtheta_iter), thresh);
             ndone_iter = 0;
-            //madness::print("start", SystolicMatrixAlgorithm::get_world().rank(),iter,tol);
+            maxtheta_iter = 0.0;
         }
     }
 
@@ -269,12 +277,11 @@ public:
             int ndone = ndone_iter;
             SystolicMatrixAlgorithm<double>::get_world().gop.sum(ndone);
             ndone_iter = ndone;
-            //madness::print("end", SystolicMatrixAlgorithm::get_world().rank(),iter,ndone);
+            SystolicMatrixAlgorithm<double>::get_world().gop.max(maxtheta_iter);
         }
     }
 
     bool converged(const TaskThreadEnv& env) const {
-        //if (env.id() == 0) madness::print("converged", SystolicMatrixAlgorithm::get_world().rank(),iter,int(ndone_iter), tol, thresh, (ndone_iter == 0 && tol == thresh));
         return (ndone_iter == 0 && tol == thresh);
     }
 
@@ -284,17 +291,22 @@ public:
         double * MADNESS_RESTRICT Cj = rowj;
         double * MADNESS_RESTRICT Ui = Ci + nao;
         double * MADNESS_RESTRICT Uj = Cj + nao;
+        double * MADNESS_RESTRICT Qi = Ui + nmo;
+        double * MADNESS_RESTRICT Qj = Uj + nmo;
 
         localize_PM_ij(set[i], set[j],
                        Ci, Cj,
-                       Ui, Uj);
+                       Ui, Uj,
+                       Qi, Qj);
     }
 };
 
 
+// Localizes the orbitals given by their overlaps dC(i,mu) = <mo_i|ao_mu> with
+// the atomic orbitals of overlap matrix S
 DistributedMatrix<double> distributed_localize_PM(World & world,
-                                                  const vecfuncT & mo,
-                                                  const vecfuncT & ao,
+                                                  const DistributedMatrix<double> & dC,
+                                                  const tensorT & S,
                                                   const std::vector<int> & set,
                                                   const std::vector<int> & at_to_bf,
                                                   const std::vector<int> & at_nbf,
@@ -303,27 +315,33 @@ DistributedMatrix<double> distributed_localize_PM(World & world,
                                                   const bool randomize = true,
                                                   const bool doprint = false)
 {
-    // Make Svec ... this can be much more efficient!
-    tensorT S = matrix_inner(world, ao, ao, true);
-    long nmo = mo.size();
+    long nmo = dC.coldim();
     long nao = S.dim(0);
     long natom = at_to_bf.size();
+    MADNESS_ASSERT(dC.rowdim() == nao);
 
     std::vector<tensorT> Svec(natom);
     for(long a = 0; a < natom; ++a){
         Slice as(at_to_bf[a], at_to_bf[a] + at_nbf[a] - 1);
         Svec[a] = copy(S(as, as));
     }
-    S = tensorT();
 
     // Make initial matrices
     DistributedMatrix<double> dU = column_distributed_matrix<double>(world, nmo, nmo);
     dU.fill_identity();
 
-    DistributedMatrix<double> dC = column_distributed_matrix<double>(world, nmo, nao);
-    matrix_inner(dC, mo, ao);
+    // Populations of the orbitals on the atoms
+    DistributedMatrix<double> dQ = column_distributed_matrix<double>(world, nmo, natom);
+    int64_t ilo, ihi;
+    dC.local_colrange(ilo, ihi);
+    for (int64_t i=ilo; i<=ihi; ++i) {
+        const double* Ci = dC.data().ptr() + (i-ilo)*nao;
+        for (long a = 0; a < natom; ++a) {
+            dQ.data()(i-ilo,a) = PM_q(Svec[a], Ci, Ci, at_to_bf[a], at_nbf[a]);
+        }
+    }
 
-    DistributedMatrix<double> dA = concatenate_rows(dC,dU);
+    DistributedMatrix<double> dA = concatenate_rows(concatenate_rows(dC,dU),dQ);
 
     // Run the systolic algorithm
     world.taskq.add(new SystolicPMOrbitalLocalize(dA, set, at_to_bf, at_nbf, Svec, thresh, thetamax, natom, nao, nmo));
@@ -332,11 +350,6 @@ DistributedMatrix<double> distributed_localize_PM(World & world,
     //print("DONE",world.rank());
 
     // Copy the data out
-    Tensor<double> A(nmo, nao+nmo+natom);
-    //    dA.copy_to_replicated(A);
-    //U(___) = A(_,Slice(nao,nao+nmo-1));
-
-
     dA.extract_columns(nao,nmo+nao-1,dU);
 
     // Fix orbital orders in parallel
@@ -379,4 +392,24 @@ DistributedMatrix<double> distributed_localize_PM(World & world,
     //return U;
 }
 
+DistributedMatrix<double> distributed_localize_PM(World & world,
+                                                  const vecfuncT & mo,
+                                                  const vecfuncT & ao,
+                                                  const std::vector<int> & set,
+                                                  const std::vector<int> & at_to_bf,
+                                                  const std::vector<int> & at_nbf,
+                                                  const double thresh = 1e-9,
+                                                  const double thetamax = 0.25,
+                                                  const bool randomize = true,
+                                                  const bool doprint = false)
+{
+    // Make Svec ... this can be much more efficient!
+    tensorT S = matrix_inner(world, ao, ao, true);
+
+    DistributedMatrix<double> dC = column_distributed_matrix<double>(world, mo.size(), S.dim(0));
+    matrix_inner(dC, mo, ao);
+
+    return distributed_localize_PM(world, dC, S, set, at_to_bf, at_nbf, thresh, thetamax, randomize, doprint);
+}
+
 }
@@ -42,6 +42,12 @@ template<typename T, std::size_t NDIM>
 std::vector<Function<T, NDIM> > Exchange<T, NDIM>::ExchangeImpl::operator()(
         const std::vector<Function<T, NDIM> >& vket) const {
 
+    // use the compressed representation if possible
+    if (ace and ace->is_valid(world, mo_bra, mo_ket, vket)) {
+        if (printlevel >= 3 and world.rank() == 0) print("applying the ACE projector for the exchange operator");
+        return ace->apply(world, vket);
+    }
+
     reconstruct(world, mo_bra, false);
     reconstruct(world, mo_ket, false);
     world.gop.fence();
@@ -70,9 +76,86 @@ std::vector<Function<T, NDIM> > Exchange<T, NDIM>::ExchangeImpl::operator()(
     }
     truncate(world, Kf);
     if (printlevel >= 3) print_timer(world);
+
+    if (ace) {
+        if (printlevel >= 3 and world.rank() == 0) print("rebuilding the ACE projector for the exchange operator");
+        ace->build(world, mo_bra, mo_ket, vket, Kf);
+    }
     return Kf;
 }
 
+template<typename T, std::size_t NDIM>
+bool Exchange<T, NDIM>::ACEProjector::is_valid(World& world, const vecfuncT& mo_bra,
+                                                const vecfuncT& mo_ket, const vecfuncT& vket) const {
+    if (empty() or vket.empty()) return false;
+    if (build_thresh != FunctionDefaults<NDIM>::get_thresh()) return false;
+
+    // the density has changed
+    functionT rho = dot(world, mo_bra, mo_ket);
+    if ((rho - density).norm2() > rebuild_thresh) return false;
+
+    // the argument is not in the span of the reference vectors: project onto the
+    // reference space and compare the norms of the projection and the argument
+    Tensor<T> ovlp = matrix_inner(world, reference, vket);     // <f_i | vket_j>
+    Tensor<T> c;
+    gesv(reference_ovlp, ovlp, c);
+    std::vector<double> vnorm = norm2s(world, vket);
+    for (std::size_t j = 0; j < vket.size(); ++j) {
+        double pnorm2 = 0.0;
+        for (long i = 0; i < reference_ovlp.dim(0); ++i) pnorm2 += std::real(std::conj(ovlp(i, j)) * c(i, j));
+        const double residual = std::sqrt(std::max(0.0, vnorm[j] * vnorm[j] - pnorm2));
+        if (residual > rebuild_thresh * std::max(1.0, vnorm[j])) return false;
+    }
+    return true;
+}
+
+template<typename T, std::size_t NDIM>
+void Exchange<T, NDIM>::ACEProjector::build(World& world, const vecfuncT& mo_bra, const vecfuncT& mo_ket,
+                                             const vecfuncT& vket, const vecfuncT& Kf) {
+    clear();
+    const long n = vket.size();
+    if (n == 0) return;
+
+    reference = copy(world, vket);
+    reference_ovlp = matrix_inner(world, reference, reference);
+    density = dot(world, mo_bra, mo_ket);
+    build_thresh = FunctionDefaults<NDIM>::get_thresh();
+
+    Tensor<T> identity(n, n);
+    for (long i = 0; i < n; ++i) identity(i, i) = 1.0;
+
+    // M = <f | K | f>, hermitian positive definite if the bra orbitals are the conjugate ket orbitals
+    Tensor<T> M = matrix_inner(world, vket, Kf);
+    const bool hermitian = (M - conj_transpose(M)).normf() < build_thresh * std::max(1.0, M.normf());
+    if (hermitian) {
+        Tensor<T> U = M + conj_transpose(M);
+        U.scale(0.5);
+        cholesky(U);        // M = U^\dagger U
+        Tensor<T> Uinv;
+        gesv(U, identity, Uinv);
+        xi = transform(world, Kf, Uinv);
+        truncate(world, xi);
+        eta = xi;
+    } else {
+        Tensor<T> Sinv;
+        gesv(reference_ovlp, identity, Sinv);
+        xi = copy(world, Kf);
+        eta = transform(world, reference, Sinv);
+        truncate(world, eta);
+    }
+    nbuild++;
+}
+
+template<typename T, std::size_t NDIM>
+std::vector<Function<T, NDIM> >
+Exchange<T, NDIM>::ACEProjector::apply(World& world, const vecfuncT& vket) const {
+    Tensor<T> c = matrix_inner(world, eta, vket);
+    vecfuncT result = transform(world, xi, c);
+    truncate(world, result);
+    napply++;
+    return result;
+}
+
 /// apply the exchange operator by tiling the exchange matrix
 
 /// compute the matrix N_{ik} = N \phi_i \phi_k by tiles, with i,k \in batches A,B,
@@ -298,6 +381,12 @@ Exchange<T, NDIM>::ExchangeImpl::MacroTaskExchangeSimple::compute_offdiagonal_ba
 template
 class Exchange<double_complex, 3>::ExchangeImpl;
 
+template
+class Exchange<double_complex, 3>::ACEProjector;
+
+template
+class Exchange<double, 3>::ACEProjector;
+
 template
 class Exchange<double, 3>::ExchangeImpl;
 
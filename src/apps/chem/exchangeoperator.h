@@ -15,6 +15,58 @@ class SCF;
 class Nemo;
 
 
+/// adaptively compressed exchange (ACE) projector
+
+/// After one full application W = K f on the vectors f the exchange operator is represented
+/// as the low-rank operator
+///    K_ACE = W M^{-1} W^\dagger = \xi \xi^\dagger,    M = <f | K | f> = U^\dagger U,   \xi = W U^{-1}
+/// which is exact on the span of f. Its application costs a matrix_inner and a transform only.
+/// If K is not hermitian (e.g. with a nuclear correlation factor in the bra) the projector
+/// K_ACE = W S^{-1} f^\dagger with the overlap S = <f | f> is used instead.
+/// The projector is invalid if the density or the argument space has changed by more
+/// than rebuild_thresh, or if the truncation threshold has changed.
+template<typename T, std::size_t NDIM>
+class Exchange<T,NDIM>::ACEProjector {
+    typedef Function<T, NDIM> functionT;
+    typedef std::vector<functionT> vecfuncT;
+
+public:
+    ACEProjector(const double rebuild_thresh) : rebuild_thresh(rebuild_thresh) {}
+
+    /// check if the projector can be applied on vket for the given orbital spaces
+    bool is_valid(World& world, const vecfuncT& mo_bra, const vecfuncT& mo_ket, const vecfuncT& vket) const;
+
+    /// construct the projector from a full application Kf=K(vket)
+    void build(World& world, const vecfuncT& mo_bra, const vecfuncT& mo_ket,
+               const vecfuncT& vket, const vecfuncT& Kf);
+
+    /// apply the projector: result_j = \sum_i xi_i <eta_i | vket_j>
+    vecfuncT apply(World& world, const vecfuncT& vket) const;
+
+    /// invalidate the projector
+    void clear() {
+        xi.clear();
+        eta.clear();
+        reference.clear();
+        density.clear();
+    }
+
+    bool empty() const {return xi.empty();}
+
+    long get_nbuild() const {return nbuild;}
+    long get_napply() const {return napply;}
+
+private:
+    double rebuild_thresh=1.e-4;
+    double build_thresh=-1.0;   ///< truncation threshold at the time of the build
+    vecfuncT xi, eta;           ///< K_ACE = \sum_i |xi_i> <eta_i|
+    vecfuncT reference;         ///< the vectors f on which K_ACE is exact
+    Tensor<T> reference_ovlp;   ///< overlap matrix <f | f>
+    functionT density;          ///< the density \sum_k bra_k ket_k at the time of the build
+    mutable long nbuild=0, napply=0;
+};
+
+
 template<typename T, std::size_t NDIM>
 class Exchange<T,NDIM>::ExchangeImpl {
     typedef Function<T, NDIM> functionT;
@@ -103,6 +155,11 @@ public:
         return *this;
     }
 
+    ExchangeImpl& set_ace(std::shared_ptr<ACEProjector> ace1) {
+        ace=ace1;
+        return *this;
+    }
+
 private:
 
     /// exchange using macrotasks, i.e. apply K on a function in individual worlds
@@ -130,6 +187,7 @@ private:
     double lo = 1.e-4;
     long printlevel = 0;
     double mul_tol = 0.0;
+    std::shared_ptr<ACEProjector> ace;  ///< adaptively compressed exchange, used if set
 
     class MacroTaskExchangeSimple : public MacroTaskOperationBase {
 
@@ -83,6 +83,9 @@ public:
     virtual bool supports_vectorized() const {return false;}
 
     static const double gamma_data[17];
+
+    /// the projectors vanish beyond this squared distance from the center
+    static constexpr double cutoff_rsq = 40.0;
     
     ProjRLMFunctor(double alpha, int l, int m, int i, const coord_3d& center) 
      : alpha(alpha), l(l), m(m), i(i), center(center) {
@@ -97,7 +100,7 @@ public:
         double x = r[0]-center[0]; double y = r[1]-center[1]; double z = r[2]-center[2];
         double rsq = x*x + y*y + z*z;
 
-        if (rsq > 40.0) return 0.0;
+        if (rsq > cutoff_rsq) return 0.0;
 
         double rr = std::sqrt(rsq);
         double rval = t1;
@@ -372,6 +375,12 @@ public:
 template <typename Q>
 class GTHPseudopotential {
 private:
+    vector_real_function_3d projectors;     ///< of all atoms with projectors, by atom, l, j, m
+    std::vector<long> projector_offset;     ///< first projector of each atom, and the total number
+    std::vector<coord_3d> projector_centers;///< the atoms, k and thresh the projectors were made for
+    int projector_k = 0;
+    double projector_thresh = 0.0;
+
 public:
     Molecule molecule;
     std::array<real_tensor,118> localp;
@@ -389,6 +398,7 @@ public:
         // Load info from file
         load_pseudo_from_file(world, "gth.xml");
         atoms_with_projectors.clear();
+        projector_offset.clear();
         
         // fill list with atoms-with-projectors (i.e. not H or He)
         for (size_t iatom = 0; iatom < molecule.natom(); iatom++) {
@@ -521,113 +531,155 @@ public:
     }
 
 
-    std::vector<Function<Q,3> > apply_potential(World& world, const real_function_3d& potential, const std::vector<Function<Q,3> >& psi, const tensorT & occ, Q & enl) {
-        double thresh = FunctionDefaults<3>::get_thresh();
-        double vtol = 1e-2*thresh;
-        std::vector<Function<Q,3> > vpsi = mul_sparse(world,(potential), psi, vtol);
+    /// The projectors of all atoms, made on the first call and again when the atoms, k or thresh change
 
-        unsigned int norbs = psi.size();
-        unsigned int natoms = atoms_with_projectors.size();
+    /// The projectors of atom \c iatom are projector_offset[iatom] to
+    /// projector_offset[iatom+1]-1, ordered by l, j and m.
+    const vector_real_function_3d& get_projectors(World& world) {
+        std::vector<coord_3d> centers;
+        for (unsigned int iatom : atoms_with_projectors) centers.push_back(molecule.get_atom(iatom).get_coords());
+        const int k = FunctionDefaults<3>::get_k();
+        const double thresh = FunctionDefaults<3>::get_thresh();
+        if (projector_offset.size() == centers.size()+1 and centers == projector_centers
+            and k == projector_k and thresh == projector_thresh) return projectors;
 
-        // NEW (VECTORIZED) ... hopefully
-        vector_real_function_3d localproj;
-        int lidx = 0;
-        unsigned int maxLL = 0;
-        // loop through all of the atom types in the molecule and get the maximum L value
-        // we need this because we are going to create a fixed sized tensor to store 
-        // mapping between a linear index and (ias=which atom, i=which projector, l=angular momentum, 
-        // m=angular momentum projection)
-        for (unsigned int iatom = 0; iatom < natoms; iatom++) {
-            // Get atom and its associated GTH tensors
+        projectors.clear();
+        projector_offset.assign(1, 0);
+        for (unsigned int iatom = 0; iatom < atoms_with_projectors.size(); iatom++) {
             Atom atom = molecule.get_atom(atoms_with_projectors[iatom]);
-            unsigned int atype = atom.atomic_number;
-            real_tensor& atom_radii = radii[atype-1];
-            if (atom_radii.dim(0) > 0)
-              maxLL = std::max(maxLL,(unsigned int)atom_radii.dim(0)-1);
+            real_tensor& atom_radii = radii[atom.atomic_number-1];
+            ProjRLMStore prlmstore(atom_radii, atom.get_coords());
+            const int maxL = atom_radii.dim(0)-1;
+            for (int l = 0; l <= maxL; l++) {
+                for (int j = 1; j <= 3; j++) {
+                    for (int m = 0; m < 2*l+1; m++) {
+                        projectors.push_back(prlmstore.nlmproj(world,l,m,j));
+                    }
+                }
+            }
+            projector_offset.push_back(projectors.size());
         }
+        world.gop.fence();
+        truncate(world, projectors, thresh);
+        compress(world, projectors);
+
+        projector_centers = centers;
+        projector_k = k;
+        projector_thresh = thresh;
+        return projectors;
+    }
 
-        // Pilm_lookup is a mapping between a linear index and (ias,i,l,m)
-        Tensor<int> Pilm_lookup((unsigned int) natoms, (unsigned long) 3, (unsigned long) maxLL+1, (unsigned long) 2*maxLL+1);
-        for (unsigned int iatom = 0; iatom < natoms; iatom++) {
-            // Get atom and its associated GTH tensors
-            Atom atom = molecule.get_atom(atoms_with_projectors[iatom]);
-            coord_3d center = atom.get_coords();
-            unsigned int atype = atom.atomic_number;
-            real_tensor& atom_radii = radii[atype-1];
-            //real_tensor& atom_hlij = hlij[atype-1];
-
-            // Create function stores for projectors
-            ProjRLMStore prlmstore(atom_radii, center);
-            for (unsigned int j = 1; j <= 3; j++) {
-                for (unsigned int l = 0; l <= maxLL; l++) {
-                    for (unsigned int m = 0; m < 2*maxLL+1; m++) {
-                       Pilm_lookup(iatom, j-1, l, m) = lidx++;
-                       if (m < 2*l+1) localproj.push_back(prlmstore.nlmproj(world,l,m,j)); 
-                       else localproj.push_back(real_factory_3d(world));
-                    }
+    /// Which atoms with projectors may overlap with which orbitals
+
+    /// An orbital is taken to live in the bounding box of its leaf boxes
+    /// whose coefficients have a norm above \c tol; an atom overlaps with it
+    /// if this box comes closer to the atom than the cutoff of the projectors.
+    /// Collective, \c psi must be reconstructed.
+    /// @return (natoms, norbs) tensor, 1 for the pairs that may overlap
+    Tensor<int> projector_overlaps(World& world, const std::vector<Function<Q,3> >& psi, double tol) const {
+        const Tensor<double>& cell = FunctionDefaults<3>::get_cell();
+        const Tensor<double>& width = FunctionDefaults<3>::get_cell_width();
+        const long norbs = psi.size();
+        const long natoms = atoms_with_projectors.size();
+
+        Tensor<double> lo(norbs, 3L), hi(norbs, 3L);
+        lo.fill(std::numeric_limits<double>::max());
+        hi.fill(-std::numeric_limits<double>::max());
+        for (long iorb = 0; iorb < norbs; iorb++) {
+            const typename FunctionImpl<Q,3>::dcT& coeffs = psi[iorb].get_impl()->get_coeffs();
+            for (auto it = coeffs.begin(); it != coeffs.end(); ++it) {
+                const FunctionNode<Q,3>& node = it->second;
+                if (not node.has_coeff() or node.coeff().normf() < tol) continue;
+                const Key<3>& key = it->first;
+                const double h = 1.0/double(Translation(1) << key.level());
+                for (int d = 0; d < 3; d++) {
+                    const double x = cell(d,0) + width(d)*h*key.translation()[d];
+                    lo(iorb,d) = std::min(lo(iorb,d), x);
+                    hi(iorb,d) = std::max(hi(iorb,d), x + width(d)*h);
+                }
+            }
+        }
+        world.gop.min(lo.ptr(), lo.size());
+        world.gop.max(hi.ptr(), hi.size());
+
+        Tensor<int> overlaps(natoms, norbs);
+        for (long iatom = 0; iatom < natoms; iatom++) {
+            const coord_3d center = molecule.get_atom(atoms_with_projectors[iatom]).get_coords();
+            for (long iorb = 0; iorb < norbs; iorb++) {
+                double rsq = 0.0;
+                for (int d = 0; d < 3; d++) {
+                    const double dist = std::max(0.0, std::max(lo(iorb,d) - center[d], center[d] - hi(iorb,d)));
+                    rsq += dist*dist;
                 }
+                overlaps(iatom,iorb) = (rsq <= ProjRLMFunctor::cutoff_rsq);
             }
-            // Somehow this scares me ... thread-safety of the container localproj (???)
-            world.gop.fence();
         }
-        truncate(world, localproj, FunctionDefaults<3>::get_thresh());
-        compress(world, localproj);
-        //truncate(world, psi, FunctionDefaults<3>::get_thresh());
+        return overlaps;
+    }
+
+    /// Local potential times psi plus the nonlocal pseudopotential applied to psi
+
+    /// The overlaps of all projectors with all orbitals are computed with a
+    /// single matrix_inner, the coefficients h_l of each atom are applied to
+    /// them as 3x3 matrix multiplies, and the results are formed with a
+    /// single transform.  The pairs of atoms and orbitals that do not
+    /// overlap (see projector_overlaps) are dropped before the transform,
+    /// so its cost grows with the number of overlapping pairs rather than
+    /// with atoms times orbitals.  The projectors are kept between calls.
+    /// @param[out] enl the nonlocal energy, sum of occ(i)*<psi_i|V_nl|psi_i>
+    std::vector<Function<Q,3> > apply_potential(World& world, const real_function_3d& potential, const std::vector<Function<Q,3> >& psi, const tensorT & occ, Q & enl) {
+        double thresh = FunctionDefaults<3>::get_thresh();
+        double vtol = 1e-2*thresh;
+        std::vector<Function<Q,3> > vpsi = mul_sparse(world,(potential), psi, vtol);
+
+        const long norbs = psi.size();
+        const long natoms = atoms_with_projectors.size();
+        const Tensor<int> overlaps = projector_overlaps(world, psi, vtol);
+
+        enl = 0.0;
+        const vector_real_function_3d& localproj = get_projectors(world);
+        const std::vector<long>& offset = projector_offset;
+        if (localproj.empty()) return vpsi;
+
         compress(world, psi);
-        //truncate(world, vpsi, FunctionDefaults<3>::get_thresh());
         compress(world, vpsi);
 
+        // P(p,iorb) = <p|psi_iorb>, dropping the pairs that do not overlap
         Tensor<Q> Pilm = matrix_inner(world, localproj, psi);
-        Pilm = Pilm.reshape(natoms, 3, maxLL+1, 2*maxLL+1, norbs);
-
-        Tensor<Q> Qilm((unsigned int) natoms, (unsigned long) 3, (unsigned long) maxLL+1, (unsigned long) 2*maxLL+1, (unsigned int) norbs);
-        for (unsigned int iorb=0; iorb<psi.size(); iorb++) {
-            for (unsigned int iatom = 0; iatom < natoms; iatom++) {
-                // Get atom and its associated GTH tensors
-                Atom atom = molecule.get_atom(atoms_with_projectors[iatom]);
-                unsigned int atype = atom.atomic_number;
-                real_tensor& atom_radii = radii[atype-1];
-                real_tensor& atom_hlij = hlij[atype-1];
-                int maxL = atom_radii.dim(0)-1;
-                for (unsigned int i = 1; i <= 3; i++) {
-                    for (int l = 0; l <= maxL; l++) {
-                        for (int m = 0; m < 2*l+1; m++) {
-                            Q s = 0.0;
-                            for (unsigned int j = 1; j <= 3; j++) {
-                                s += atom_hlij(l,i-1,j-1)*Pilm(iatom, j-1,l,m,iorb);
-                            }
-                            Qilm(iatom, i-1,l,m,iorb) = s;
-                        }
-                    }
+        for (long iatom = 0; iatom < natoms; iatom++) {
+            for (long iorb = 0; iorb < norbs; iorb++) {
+                if (not overlaps(iatom,iorb)) {
+                    Pilm(Slice(offset[iatom],offset[iatom+1]-1),iorb) = Q(0.0);
                 }
             }
         }
-        Qilm = Qilm.reshape(natoms*3*(maxLL+1)*(2*maxLL+1),norbs);
+
+        // Q(i,m,iorb) = sum_j h_l(i,j) P(j,m,iorb) for each atom and l
+        Tensor<Q> Qilm(Pilm.dim(0), Pilm.dim(1));
+        for (long iatom = 0; iatom < natoms; iatom++) {
+            Atom atom = molecule.get_atom(atoms_with_projectors[iatom]);
+            real_tensor& atom_hlij = hlij[atom.atomic_number-1];
+            const int maxL = radii[atom.atomic_number-1].dim(0)-1;
+            long p0 = offset[iatom];
+            for (int l = 0; l <= maxL; l++) {
+                const long nrow = 3*(2*l+1);
+                const Slice rows(p0, p0+nrow-1);
+                const real_tensor h = copy(atom_hlij(l,_,_));
+                Qilm(rows,_) = inner(h, Pilm(rows,_).reshape(3, (2*l+1)*norbs)).reshape(nrow, norbs);
+                p0 += nrow;
+            }
+        }
 
         double vtol2 = 1e-4*thresh;
         double trantol = vtol2 / std::min(30.0, double(localproj.size()));
-        vector_real_function_3d dpsi = transform(world, localproj, Qilm, trantol, true);
+        std::vector<Function<Q,3> > dpsi = transform(world, localproj, Qilm, trantol, true);
 
-        // calculate non-local energy
-        tensorT nlmat = matrix_inner(world, dpsi, psi, true);
+        // calculate non-local energy, <dpsi_i|psi_i> = sum_p conj(Q(p,i)) P(p,i)
         int nocc = occ.size();
-        enl = 0.0;
-        for(int i = 0;i < nocc;++i){
-            enl += occ[i] * nlmat(i, i);
-        }
-
-        //debug printing
-        /*tensorT lmat = matrix_inner(world, vpsi, psi, true);
-        Q el = 0.0;
         for(int i = 0;i < nocc;++i){
-            el += occ[i] * lmat(i, i);
-            std::cout << "nloc/loc " << i << "  " << occ[i] << "  " << nlmat(i,i) << "  "<< lmat(i,i) << std::endl;
+            enl += occ[i] * Qilm(_,i).trace_conj(Pilm(_,i));
         }
 
-        if(world.rank() == 0){
-            printf("\n              enl, el, epot %16.8f  %16.8f  %16.8f\n", enl, el, enl+el);
-        }*/
-
         gaxpy(world, 1.0, vpsi, 1.0, dpsi);
 
         return vpsi;
@@ -171,6 +171,12 @@ double MP2::value(const Tensor<double>& x) {
     correlation_energy = 0.0;
     if (world.rank() == 0) print("localize ", hf->get_calc().param.do_localize());
 
+    // keep only some of the pair functions in memory
+    if (param.pair_memory() > 0.0 and not pairstore) {
+        const double budget = param.pair_memory() * 1024.0 * 1024.0 * 1024.0;
+        pairstore.reset(new pairstoreT(world, "mp2_pairstore", budget));
+    }
+
     // compute only one single pair
     if ((param.i() > -1) and (param.j() > -1)) {
         pairs(param.i(), param.j()) = make_pair(param.i(), param.j());    // initialize
@@ -201,6 +207,7 @@ double MP2::value(const Tensor<double>& x) {
                                      param.dconv());
             correlation_energy += pairs(i, j).e_singlet
                                   + pairs(i, j).e_triplet;
+            stash_pair(pairs(i, j));
         }
     }
     if (world.rank() == 0) {
@@ -209,7 +216,11 @@ double MP2::value(const Tensor<double>& x) {
 
     correlation_energy = 0.0;
     if (hf->get_calc().param.do_localize()) {
-        // solve the coupled MP1 equations
+        // solve the coupled MP1 equations; the coupling needs all pairs at once
+        for (int i = param.freeze(); i < hf->nocc(); ++i) {
+            for (int j = i; j < hf->nocc(); ++j) fetch_pair(pairs(i, j));
+        }
+        pairstore.reset();
         correlation_energy = solve_coupled_equations(pairs, param.econv() * 0.1, param.dconv());
 
     } else {
@@ -217,15 +228,39 @@ double MP2::value(const Tensor<double>& x) {
         // solve the canonical MP1 equations with increased accuracy
         for (int i = param.freeze(); i < hf->nocc(); ++i) {
             for (int j = i; j < hf->nocc(); ++j) {
+                fetch_pair(pairs(i, j));
+                if (j + 1 < hf->nocc()) prefetch_pair(i, j + 1);
+                else if (i + 1 < hf->nocc()) prefetch_pair(i + 1, i + 1);
                 pairs(i, j).converged = false;
                 solve_residual_equations(pairs(i, j), param.econv() * 0.05, param.dconv());
                 correlation_energy += pairs(i, j).e_singlet + pairs(i, j).e_triplet;
+                stash_pair(pairs(i, j));
             }
         }
     }
     return correlation_energy;
 }
 
+void MP2::stash_pair(ElectronPair& pair) {
+    if (not pairstore) return;
+    pairstore->set(std::make_tuple(pair.i, pair.j, 0), pair.function);
+    pairstore->set(std::make_tuple(pair.i, pair.j, 1), pair.constant_term);
+    pair.function = real_function_6d();
+    pair.constant_term = real_function_6d();
+}
+
+void MP2::fetch_pair(ElectronPair& pair) {
+    if (not pairstore or not pairstore->contains(std::make_tuple(pair.i, pair.j, 0))) return;
+    pair.function = pairstore->get(std::make_tuple(pair.i, pair.j, 0));
+    pair.constant_term = pairstore->get(std::make_tuple(pair.i, pair.j, 1));
+}
+
+void MP2::prefetch_pair(const int i, const int j) {
+    if (not pairstore) return;
+    pairstore->prefetch(std::make_tuple(i, j, 0));
+    pairstore->prefetch(std::make_tuple(i, j, 1));
+}
+
 /// solve the residual equation for electron pair (i,j)
 void MP2::solve_residual_equations(ElectronPair& result,
                                    const double econv, const double dconv) const {
@@ -45,6 +45,7 @@
 #include <chem/QCCalculationParametersBase.h>
 #include <chem/SCF.h>
 #include <madness/mra/nonlinsol.h>
+#include <madness/mra/functionstore.h>
 #include <chem/projector.h>
 #include <chem/correlationfactor.h>
 #include <chem/electronic_correlation_factor.h>
@@ -329,6 +330,8 @@ class MP2 : public OptimizationTargetInterface {
             initialize < int > ("maxsub", 2);
             initialize < bool > ("restart", true);
             initialize < int > ("maxiter", 5);
+            initialize < double > ("pair_memory", 0.0, "GByte of pair functions per process kept in memory, "
+                                   "the others go to a scratch file; 0 keeps all pairs in memory");
 
             read_and_set_derived_values(world,parser);
 
@@ -359,6 +362,7 @@ class MP2 : public OptimizationTargetInterface {
         int j() const { return this->get<std::vector<int> >("pair")[1]; }    /// convenience function
         int restart() const { return this->get<bool>("restart"); }    /// convenience function
         int maxiter() const { return this->get<int>("maxiter"); }    /// convenience function
+        double pair_memory() const { return this->get<double>("pair_memory"); }    /// convenience function
         int maxsub() const { return this->get<int>("maxsub"); }    /// convenience function
         bool do_oep() const { return do_oep1;}
     };
@@ -396,6 +400,8 @@ class MP2 : public OptimizationTargetInterface {
     mutable Tensor<double> fock;            ///< the Fock matrix
 
     Pairs<ElectronPair> pairs;       ///< pair functions and energies
+    typedef FunctionStore<std::tuple<int, int, int>, double, 6> pairstoreT;
+    std::shared_ptr<pairstoreT> pairstore;  ///< holds the pair functions if param.pair_memory() is set
     double correlation_energy;                ///< the correlation energy
     double coords_sum;                        ///< check sum for the geometry
 
@@ -405,6 +411,15 @@ private:
 
     std::shared_ptr<real_convolution_3d> poisson;
 
+    /// hand the functions of the pair over to the pairstore, if there is one
+    void stash_pair(ElectronPair& pair);
+
+    /// take the functions of the pair back from the pairstore, if there is one
+    void fetch_pair(ElectronPair& pair);
+
+    /// start reading the functions of pair (i,j) from the pairstore in the background
+    void prefetch_pair(const int i, const int j);
+
 public:
 
     /// ctor
@@ -69,6 +69,18 @@ public:
 
     std::string symbol() const {return symbol_;}
 
+    /// the sign of each coordinate after applying this operator, which must not map dimensions
+
+    /// e.g. {1,-1,-1} for C_2(x); all operators of the point groups in
+    /// projector_irrep are of this kind
+    std::vector<long> mirror_signs(const std::size_t ndim) const {
+    	MADNESS_ASSERT(mapdim_.empty());
+    	if (name_=="identity") return std::vector<long>(ndim,1);
+    	if (name_=="inversion") return std::vector<long>(ndim,-1);
+    	MADNESS_ASSERT(mirrormap.size()==ndim);
+    	return mirrormap;
+    }
+
 	/// apply the operator on an n-dimensional MRA function
 	template<typename T, std::size_t NDIM>
 	Function<T,NDIM> operator()(const Function<T,NDIM>& f, bool fence=true) const {
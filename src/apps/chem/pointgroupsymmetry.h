@@ -170,6 +170,9 @@ public:
 	/// get the verbosity level
 	bool get_orthonormalize_irreps() const {return orthonormalize_irreps_;}
 
+	/// get the irrep on which this projector projects
+	std::string get_irrep() const {return irrep_;}
+
 	/// get the point group name
 	std::string get_pointgroup() const {return table_.schoenflies_;}
 
@@ -0,0 +1,291 @@
+/*
+  This file is part of MADNESS.
+
+  Copyright (C) 2007,2010 Oak Ridge National Laboratory
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+
+  For more information please contact:
+
+  Robert J. Harrison
+  Oak Ridge National Laboratory
+  One Bethel Valley Road
+  P.O. Box 2008, MS-6367
+
+  email: harrisonrj@ornl.gov
+  tel:   865-241-3937
+  fax:   865-572-0680
+
+  $Id$
+*/
+
+/*!
+  \file chem/symmetry_reduced_function.h
+  \brief Functions of an irrep that store only the boxes of the irreducible wedge
+
+	\par Introduction
+	All point groups of projector_irrep are abelian and consist of reflections
+	of the coordinates, e.g. C_2(z): (x,y,z) -> (-x,-y,z).  If the simulation
+	cell is centered at the origin, each of these operators maps the boxes of
+	a level onto boxes of the same level, and the |G| images of the boxes in
+	the irreducible wedge (e.g. the octant x,y,z>0 for d2h) tile the cell on
+	every level but the coarsest one.  A function f of irrep Gamma satisfies
+	f(g r) = chi_Gamma(g) f(r), so its coefficients in a box follow from the
+	ones in the image of the box in the wedge.
+
+	symmetry_reduced_function stores f only in the boxes of the wedge (as an
+	ordinary Function that vanishes outside the wedge) together with its
+	irrep, and
+	 - inner() and norm2() work on the wedge only;
+	 - mul() multiplies on the wedge only, since the product in a box only
+	   depends on the factors in the same box;
+	 - apply() applies the operator to the wedge only and adds the images
+	   of the result falling into the wedge, which is correct for operators
+	   that commute with the symmetry operators, like the Coulomb and BSH
+	   operators;
+	 - expand() reconstructs the full function from the images of the wedge.
+	This saves up to a factor of |G| in memory, and in the work of these
+	operations.
+
+	\par Example
+	\code
+	projector_irrep proj("d2h","b1u");
+	symmetry_reduced_function<double,3> f(proj,orbital);	// projects on b1u
+	symmetry_reduced_function<double,3> Vf=apply(coulomb,mul(rho,f));
+	real_function_3d full=Vf.expand();
+	\endcode
+*/
+
+#ifndef SRC_APPS_CHEM_SYMMETRY_REDUCED_FUNCTION_H_
+#define SRC_APPS_CHEM_SYMMETRY_REDUCED_FUNCTION_H_
+
+#include <madness/mra/mra.h>
+#include <chem/pointgroupsymmetry.h>
+
+namespace madness {
+
+/// The boxes that represent all boxes of a level under the operators of a point group
+
+/// The operators are sign masks of the coordinates and form a vector space
+/// over Z_2.  With a basis in reduced echelon form, each basis vector flips
+/// its pivot dimension and no other pivot, so the images of a box contain
+/// exactly one box in the upper half of the cell in all pivot dimensions.
+class irreducible_wedge {
+	int order_=1;				///< order of the point group
+	std::vector<int> pivots_;	///< dimensions in which the wedge is the upper half of the cell
+
+public:
+	irreducible_wedge() = default;
+
+	irreducible_wedge(const charactertable& table, const std::size_t ndim) : order_(table.order_) {
+		std::vector<unsigned int> basis;
+		for (const pg_operator& op : table.operators_) {
+			const std::vector<long> signs=op.mirror_signs(ndim);
+			unsigned int mask=0;
+			for (std::size_t d=0; d<ndim; ++d) if (signs[d]==-1) mask|=(1u<<d);
+
+			for (std::size_t i=0; i<basis.size(); ++i) {
+				if (mask & (1u<<pivots_[i])) mask^=basis[i];
+			}
+			if (mask==0) continue;
+			int pivot=0;
+			while (not (mask & (1u<<pivot))) ++pivot;
+			for (unsigned int& b : basis) if (b & (1u<<pivot)) b^=mask;
+			basis.push_back(mask);
+			pivots_.push_back(pivot);
+		}
+		MADNESS_ASSERT((1<<basis.size())==order_);
+	}
+
+	/// order of the point group, i.e. the number of images of a box on levels > 0
+	int order() const {return order_;}
+
+	/// dimensions in which the wedge is the upper half of the cell
+	const std::vector<int>& pivots() const {return pivots_;}
+
+	/// true if the box is in the wedge; the parent of a box in the wedge is in the wedge
+	template<std::size_t NDIM>
+	bool contains(const Key<NDIM>& key) const {
+		const Level n=key.level();
+		if (n==0) return true;
+		const Translation half=Translation(1)<<(n-1);
+		for (int d : pivots_) if (key.translation()[d]<half) return false;
+		return true;
+	}
+};
+
+
+/// A Function of an irrep that stores only its boxes in the irreducible wedge, see symmetry_reduced_function.h
+template<typename T, std::size_t NDIM>
+class symmetry_reduced_function {
+	typedef Function<T,NDIM> functionT;
+	typedef FunctionNode<T,NDIM> nodeT;
+	typedef GenTensor<T> coeffT;
+
+	projector_irrep proj_;			///< the point group and the irrep
+	irreducible_wedge wedge_;
+	functionT f_;					///< the function in the boxes of the wedge, zero elsewhere
+
+	/// result of an operation: f is the function in the wedge
+	symmetry_reduced_function(const projector_irrep& proj, const irreducible_wedge& wedge,
+			const functionT& f) : proj_(proj), wedge_(wedge), f_(f) {}
+
+	/// characters of the irrep, in the order of the operators
+	std::vector<int> characters() const {
+		const charactertable table=proj_.get_table();
+		return table.irreps_.find(proj_.get_irrep())->second;
+	}
+
+	/// sum of the images of h, weighted with factor times the characters of the irrep
+	functionT fold(const functionT& h, const double factor) const {
+		const charactertable table=proj_.get_table();
+		const std::vector<int> chi=characters();
+		functionT result;
+		for (std::size_t i=0; i<table.operators_.size(); ++i) {
+			functionT image=table.operators_[i](h);
+			image.compress();
+			if (i==0) result=image.scale(T(factor*chi[i]));
+			else result.gaxpy(T(1.0),image,T(factor*chi[i]),false);
+		}
+		result.world().gop.fence();
+		return result;
+	}
+
+	/// remove all boxes outside the wedge from f
+
+	/// The children of the root outside the wedge become zero leaves, so f
+	/// remains a valid Function that vanishes outside the wedge.  f must be
+	/// refined beyond the root, which is always the case in practice.
+	void restrict_to_wedge(functionT& f) const {
+		f.reconstruct();
+		typename FunctionImpl<T,NDIM>::dcT& coeffs=f.get_impl()->get_coeffs();
+		const coeffT zero(f.get_impl()->get_cdata().vk,f.get_impl()->get_tensor_args());
+		std::vector<Key<NDIM> > outside;
+		for (auto it=coeffs.begin(); it!=coeffs.end(); ++it) {
+			if (not wedge_.contains(it->first)) outside.push_back(it->first);
+		}
+		for (const Key<NDIM>& key : outside) {
+			if (key.level()==1) coeffs.replace(key,nodeT(copy(zero),false));
+			else coeffs.erase(key);
+		}
+		f.world().gop.fence();
+	}
+
+public:
+
+	/// project f on the irrep of proj and keep the boxes of the irreducible wedge
+
+	/// @param[in]	proj	the point group and the irrep, which must not be "all"
+	/// @param[in]	f		any function
+	symmetry_reduced_function(const projector_irrep& proj, const functionT& f)
+		: proj_(proj), wedge_(proj.get_table(),NDIM) {
+		MADNESS_ASSERT(proj_.get_irrep()!="all");
+		const Tensor<double> cell=FunctionDefaults<NDIM>::get_cell();
+		for (std::size_t d=0; d<NDIM; ++d) {
+			if (std::abs(cell(d,0)+cell(d,1))>1.e-12*(cell(d,1)-cell(d,0))) {
+				MADNESS_EXCEPTION("symmetry_reduced_function: cell is not centered at the origin",d);
+			}
+		}
+		f_=fold(f,1.0/wedge_.order());
+		restrict_to_wedge(f_);
+	}
+
+	World& world() const {return f_.world();}
+
+	/// the irrep of this function
+	std::string irrep() const {return proj_.get_irrep();}
+
+	/// the point group and the irrep
+	const projector_irrep& projector() const {return proj_;}
+
+	const irreducible_wedge& wedge() const {return wedge_;}
+
+	/// the function in the boxes of the wedge, zero elsewhere
+	const functionT& get_function() const {return f_;}
+
+	/// the full function, made from the images of the wedge
+	functionT expand() const {
+		functionT result=fold(f_,1.0);
+		result.reconstruct();
+		return result;
+	}
+
+	/// number of boxes stored, about 1/|G| of the full function
+	std::size_t tree_size() const {return f_.tree_size();}
+
+	/// L2 norm of the full function
+	double norm2() const {
+		return std::sqrt(double(wedge_.order()))*f_.norm2();
+	}
+
+	symmetry_reduced_function& scale(const T factor) {
+		f_.scale(factor);
+		return *this;
+	}
+
+	symmetry_reduced_function& truncate(const double tol=0.0) {
+		f_.truncate(tol);
+		restrict_to_wedge(f_);
+		return *this;
+	}
+
+	/// sum of two functions of the same irrep
+	symmetry_reduced_function operator+(const symmetry_reduced_function& other) const {
+		MADNESS_ASSERT(irrep()==other.irrep());
+		functionT result=f_+other.f_;
+		return symmetry_reduced_function(proj_,wedge_,result);
+	}
+
+	/// difference of two functions of the same irrep
+	symmetry_reduced_function operator-(const symmetry_reduced_function& other) const {
+		MADNESS_ASSERT(irrep()==other.irrep());
+		functionT result=f_-other.f_;
+		return symmetry_reduced_function(proj_,wedge_,result);
+	}
+
+	/// inner product of the full functions, zero for different irreps
+	friend T inner(const symmetry_reduced_function& a, const symmetry_reduced_function& b) {
+		MADNESS_ASSERT(a.proj_.get_pointgroup()==b.proj_.get_pointgroup());
+		if (a.irrep()!=b.irrep()) return T(0.0);
+		return T(double(a.wedge_.order()))*inner(a.f_,b.f_);
+	}
+
+	/// pointwise product, of the product irrep
+	friend symmetry_reduced_function mul(const symmetry_reduced_function& a,
+			const symmetry_reduced_function& b, const bool fence=true) {
+		MADNESS_ASSERT(a.proj_.get_pointgroup()==b.proj_.get_pointgroup());
+		const std::vector<std::string> irreps=a.proj_.reduce(a.irrep(),b.irrep());
+		MADNESS_ASSERT(irreps.size()==1);
+		projector_irrep proj=a.proj_;
+		proj.set_irrep(irreps.front());
+		a.f_.reconstruct();
+		b.f_.reconstruct();
+		functionT result=mul(a.f_,b.f_,fence);
+		a.restrict_to_wedge(result);
+		return symmetry_reduced_function(proj,a.wedge_,result);
+	}
+
+	/// apply an operator that commutes with the symmetry operators, e.g. Coulomb or BSH
+	template<typename opT>
+	friend symmetry_reduced_function apply(const opT& op, const symmetry_reduced_function& f) {
+		functionT result=f.fold(apply(op,f.f_),1.0);
+		f.restrict_to_wedge(result);
+		return symmetry_reduced_function(f.proj_,f.wedge_,result);
+	}
+};
+
+} /* namespace madness */
+
+#endif /* SRC_APPS_CHEM_SYMMETRY_REDUCED_FUNCTION_H_ */
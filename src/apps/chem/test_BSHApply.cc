@@ -114,9 +114,10 @@ std::vector<Function<double_complex,NDIM> > mix(const std::vector<Function<doubl
 
 /// test the n-dimensional harmonic oscillator
 template<typename T, std::size_t NDIM>
-int test_converged_function(World& world, double shift, bool coupling) {
+int test_converged_function(World& world, double shift, bool coupling, double bucket_width=0.0) {
 	int result=0;
-	test_output test("testing NDIM= "+std::to_string(NDIM)+" coupling= "+std::to_string(coupling)+" shift= "+std::to_string(shift));
+	test_output test("testing NDIM= "+std::to_string(NDIM)+" coupling= "+std::to_string(coupling)+" shift= "+std::to_string(shift)
+			+" bucket_width= "+std::to_string(bucket_width));
 
 	// the potential is V(r) = 0.5 k r^2 = 0.5 omega^2 r^2 (m=1)
 	const double k=1.0;
@@ -164,6 +165,7 @@ int test_converged_function(World& world, double shift, bool coupling) {
 	BSHApply<T,NDIM> bsh_apply(world);
 	bsh_apply.do_coupling=coupling;
 	bsh_apply.levelshift=shift;
+	bsh_apply.bucket_width=bucket_width;
 	auto [residual,eps_update]=bsh_apply(vf,fock,potential*vf);
 
 	// test residual norm
@@ -262,6 +264,8 @@ int main(int argc, char** argv) {
 #endif
     	    result+=test_convergence<double,2>(world,shift,coupling);
     	}
+    	// both functions share one operator
+    	result+=test_converged_function<double,2>(world,-5.0,coupling,1.0);
     }
 
     print("result",result);
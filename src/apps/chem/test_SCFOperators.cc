@@ -32,6 +32,7 @@
 //#define WORLD_INSTANTIATE_STATIC_TEMPLATES
 #include <madness.h>
 #include <chem/SCFOperators.h>
+#include <chem/exchangeoperator.h>
 #include <chem/SCF.h>
 #include <chem/nemo.h>
 #include <chem/correlationfactor.h>
@@ -522,6 +523,65 @@ int test_exchange(World& world) {
     return 0;
 }
 
+/// test the adaptively compressed exchange (ACE) representation against the full operator
+template<typename T>
+int test_exchange_ace(World& world) {
+
+    FunctionDefaults<3>::set_thresh(1.e-5);
+    double thresh=FunctionDefaults<3>::get_thresh();
+    if (world.rank()==0) print("\nentering test_exchange_ace",thresh,typeid(T).name());
+    FunctionDefaults<3>::set_cubic_cell(-10, 10);
+
+    const int nmo=2;
+    Tensor<double> alpha(nmo);
+    alpha(0l)=1.0;
+    alpha(1l)=2.0;
+    Vector<double,3> origin(0.0);
+
+    std::vector<Function<T,3> > amo(nmo);
+    for (int i=0; i<nmo; ++i) {
+        amo[i]=FunctionFactory<T,3>(world).truncate_on_project()
+                .functor(GaussianGuess<T,3>(origin,alpha(i))).thresh(thresh*0.1);
+    }
+
+    Exchange<T,3> K;
+    K.set_parameters(conj(world,amo),amo,1.e-4);
+    const std::vector<Function<T,3> > Kamo_full=K(amo);
+
+    auto ace=Exchange<T,3>::make_ace_projector(1.e-3);
+    K.set_ace(ace);
+    K(amo);                         // full build of the projector
+    std::vector<Function<T,3> > Kamo=K(amo);   // ACE application
+    if (ace->get_nbuild()!=1 or ace->get_napply()!=1) {
+        print("ACE projector not reused",ace->get_nbuild(),ace->get_napply());
+        return 1;
+    }
+    double err=norm2(world,sub(world,Kamo,Kamo_full));
+    if (world.rank()==0) print("error of K_ACE on the reference space",err);
+    if (check_err(err,thresh,"ACE exchange error")) return 1;
+
+    // rotated orbitals are in the span of the reference vectors
+    Tensor<T> U(nmo,nmo);
+    U(0,0)=U(1,1)=std::cos(0.3);
+    U(0,1)=std::sin(0.3);
+    U(1,0)=-std::sin(0.3);
+    std::vector<Function<T,3> > rotated=transform(world,amo,U);
+    err=norm2(world,sub(world,K(rotated),transform(world,Kamo_full,U)));
+    if (world.rank()==0) print("error of K_ACE on rotated orbitals",err);
+    if (check_err(err,thresh,"ACE exchange error on rotated orbitals")) return 1;
+    if (ace->get_nbuild()!=1) return 1;
+
+    // a function outside the reference space triggers a rebuild
+    std::vector<Function<T,3> > other(1);
+    other[0]=FunctionFactory<T,3>(world).functor(GaussianGuess<T,3>(Vector<double,3>(1.0),1.5));
+    K(other);
+    if (ace->get_nbuild()!=2) {
+        print("ACE projector not rebuilt",ace->get_nbuild());
+        return 1;
+    }
+    return 0;
+}
+
 template<typename T>
 int test_XCOperator(World& world) {
 
@@ -982,6 +1042,10 @@ int main(int argc, char** argv) {
     	result+=test_exchange<double>(world);
 #ifndef HAVE_GENTENSOR
     	result+=test_exchange<double_complex>(world);
+#endif
+    	result+=test_exchange_ace<double>(world);
+#ifndef HAVE_GENTENSOR
+    	result+=test_exchange_ace<double_complex>(world);
 #endif
     	result+=test_XCOperator<double>(world);
 #ifndef HAVE_GENTENSOR
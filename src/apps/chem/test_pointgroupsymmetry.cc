@@ -33,6 +33,7 @@
 #include <madness/mra/functypedefs.h>
 #include <chem/pointgroupoperator.h>
 #include <chem/pointgroupsymmetry.h>
+#include <chem/symmetry_reduced_function.h>
 
 using namespace madness;
 
@@ -383,6 +384,68 @@ int test_orthogonalization(World& world) {
 	return result;
 }
 
+/// store functions on the irreducible wedge, compare operations with the full functions
+int test_symmetry_reduced_function(World& world) {
+
+	print("test symmetry-reduced functions");
+	const real_function_3d f=real_factory_3d(world).f(gaussian_shift_3d);
+	const real_function_3d g=real_factory_3d(world).f(dgaussian);
+	const real_convolution_3d coulomb=CoulombOperator(world,1.e-4,FunctionDefaults<3>::get_thresh());
+
+	double error=0.0;
+	std::string all_pg[]={"cs","c2","ci","c2v","c2h","d2","d2h"};
+	for (const std::string& pg : all_pg) {
+		projector_irrep proj(pg);
+		charactertable table=proj.get_table();
+		std::vector<std::string> irreps=proj.get_all_irreps();
+
+		// f in the first irrep, g in the last one
+		proj.set_irrep(irreps.front());
+		symmetry_reduced_function<double,3> fr(proj,f);
+		proj.set_irrep(irreps.back());
+		symmetry_reduced_function<double,3> gr(proj,g);
+
+		// the projection on the irrep
+		real_function_3d fsym=real_factory_3d(world);
+		real_function_3d gsym=real_factory_3d(world);
+		for (int i=0; i<table.order_; ++i) {
+			fsym+=table.irreps_[irreps.front()][i]/double(table.order_)*table.operators_[i](f);
+			gsym+=table.irreps_[irreps.back()][i]/double(table.order_)*table.operators_[i](g);
+		}
+		const real_function_3d ffull=fr.expand();
+		const real_function_3d gfull=gr.expand();
+		const double e1=(ffull-fsym).norm2() + (gfull-gsym).norm2();
+
+		// storage
+		const double ratio=double(fsym.tree_size())/fr.tree_size();
+
+		// inner products and norms
+		const double e2=std::abs(inner(fr,fr)-inner(fsym,fsym)) + std::abs(inner(fr,gr)-inner(fsym,gsym))
+				+ std::abs(fr.norm2()-fsym.norm2());
+
+		// products
+		symmetry_reduced_function<double,3> fg=mul(fr,gr);
+		const double e3=(fg.expand()-fsym*gsym).norm2();
+
+		// operators
+		const real_function_3d vfsym=apply(coulomb,fsym);
+		const double e4=(apply(coulomb,fr).expand()-vfsym).norm2()/vfsym.norm2();
+
+		print(" point group, irreps, storage ratio, errors ",pg,fr.irrep(),gr.irrep(),fg.irrep(),ratio,e1,e2,e3,e4);
+		if (ratio<0.6*table.order_) error+=1.0;
+		error+=e1+e2+e3+1.e-3*e4;
+	}
+
+	int result=0;
+	if (error > 1.e-8) {
+		print("large error norm test_symmetry_reduced_function:", error);
+		result=1;
+	} else {
+		print("  .. all good");
+	}
+	return result;
+}
+
 int main(int argc, char** argv) {
     madness::initialize(argc, argv);
 
@@ -399,6 +462,7 @@ int main(int argc, char** argv) {
     result+=check_multiplication_table_c2v(world);
     result+=test_projector(world);
     result+=test_orthogonalization(world);
+    result+=test_symmetry_reduced_function(world);
 //    plot_symmetry_operators(world);
 
     print("result",result);
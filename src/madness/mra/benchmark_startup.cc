@@ -0,0 +1,42 @@
+/*
+ * benchmark_startup.cc
+ *
+ * times startup() and the first use of the displacements it no longer makes;
+ * set MRA_DATA_DIR to the directory of the text files to time parsing them
+ */
+
+#include <madness/mra/mra.h>
+#include <madness/world/timers.h>
+
+using namespace madness;
+
+template <std::size_t NDIM>
+static double time_displacements() {
+    double wall = wall_time();
+    Displacements<NDIM>().get_disp(0, false);
+    if (NDIM <= 3) {
+        for (Level n=0; n<Level(8*sizeof(Translation) - 2); ++n) Displacements<NDIM>().get_disp(n, true);
+    }
+    return wall_time() - wall;
+}
+
+int main(int argc, char** argv) {
+    World& world = initialize(argc, argv);
+
+    world.gop.fence();
+    double wall = wall_time();
+    startup(world, argc, argv);
+    world.gop.fence();
+    const double tstartup = wall_time() - wall;
+
+    const double t3 = time_displacements<3>();
+    const double t6 = time_displacements<6>();
+
+    if (world.rank() == 0) {
+        print("startup                ", tstartup, "s");
+        print("first use of displacements, 3D", t3, "s");
+        print("first use of displacements, 6D", t6, "s");
+    }
+    finalize();
+    return 0;
+}
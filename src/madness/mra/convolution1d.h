@@ -334,7 +334,8 @@ namespace madness {
         /// function which in turn are computed from the matrix elements
         /// over the double order legendre polynomials.
         const Tensor<Q>& rnlij(Level n, Translation lx, bool do_transpose=false) const {
-            const Tensor<Q>* p=rnlij_cache.getptr(n,lx);
+            static const CacheCounters counters("convolution1d.rnlij_cache");
+            const Tensor<Q>* p=counters(rnlij_cache.getptr(n,lx));
             if (p) return *p;
 
             // PROFILE_MEMBER_FUNC(Convolution1D); // Too fine grain for routine profiling
@@ -367,7 +368,8 @@ namespace madness {
 
             // we cache translation and source offset
             const Key<2> cache_key(n, Vector<Translation,2>{lx, s_off} );
-            const ConvolutionData1D<Q>* p = mod_ns_cache.getptr(cache_key);
+            static const CacheCounters counters("convolution1d.mod_ns_cache");
+            const ConvolutionData1D<Q>* p = counters(mod_ns_cache.getptr(cache_key));
             if (p) return p;
 
             // for paranoid me
@@ -424,7 +426,8 @@ namespace madness {
 
         /// Returns a pointer to the cached make_nonstandard form of the operator
         const ConvolutionData1D<Q>* nonstandard(Level n, Translation lx) const {
-            const ConvolutionData1D<Q>* p = ns_cache.getptr(n,lx);
+            static const CacheCounters counters("convolution1d.ns_cache");
+            const ConvolutionData1D<Q>* p = counters(ns_cache.getptr(n,lx));
             if (p) return p;
 
             // PROFILE_MEMBER_FUNC(Convolution1D); // Too fine grain for routine profiling
@@ -496,7 +499,8 @@ namespace madness {
 
 
         const Tensor<Q>& get_rnlp(Level n, Translation lx) const {
-            const Tensor<Q>* p=rnlp_cache.getptr(n,lx);
+            static const CacheCounters counters("convolution1d.rnlp_cache");
+            const Tensor<Q>* p=counters(rnlp_cache.getptr(n,lx));
             if (p) return *p;
 
             // PROFILE_MEMBER_FUNC(Convolution1D); // Too fine grain for routine profiling
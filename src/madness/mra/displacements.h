@@ -33,6 +33,8 @@
 #ifndef MADNESS_MRA_DISPLACEMENTS_H__INCLUDED
 #define MADNESS_MRA_DISPLACEMENTS_H__INCLUDED
 
+#include <mutex>
+
 namespace madness {
     /// Holds displacements for applying operators to avoid replicating for all operators
     template <std::size_t NDIM>
@@ -40,6 +42,8 @@ namespace madness {
 
         static std::vector< Key<NDIM> > disp;
         static std::vector< Key<NDIM> > disp_periodicsum[64];
+        static std::once_flag disp_once;                ///< disp is made on first use
+        static std::once_flag disp_periodicsum_once[64];    ///< each level of disp_periodicsum is made on first use
 
     public:
         static int bmax_default() {
@@ -172,30 +176,24 @@ namespace madness {
 
 
     public:
-        Displacements() {
+        /// The displacements are made on first use, by the first thread that needs them
+        Displacements() {}
+
+        const std::vector< Key<NDIM> >& get_disp(Level n, bool isperiodicsum) {
           MADNESS_PRAGMA_CLANG(diagnostic push)
           MADNESS_PRAGMA_CLANG(diagnostic ignored "-Wundefined-var-template")
 
-          if (disp.size() == 0) {
-                make_disp(bmax_default());
-
-                if (NDIM <= 3) {
-                    Level nmax = 8*sizeof(Translation) - 2;
-                    for (Level n=0; n<nmax; ++n) make_disp_periodicsum(bmax_default(), n);
-                }
-            }
-
-          MADNESS_PRAGMA_CLANG(diagnostic pop)
-        }
-
-        const std::vector< Key<NDIM> >& get_disp(Level n, bool isperiodicsum) {
             if (isperiodicsum) {
-                MADNESS_ASSERT(NDIM <= 3);
+                MADNESS_ASSERT(NDIM <= 3 && n >= 0 && n < Level(8*sizeof(Translation) - 2));
+                std::call_once(disp_periodicsum_once[n], make_disp_periodicsum, bmax_default(), n);
                 return disp_periodicsum[n];
             }
             else {
+                std::call_once(disp_once, make_disp, bmax_default());
                 return disp;
             }
+
+          MADNESS_PRAGMA_CLANG(diagnostic pop)
         }
 
     };
@@ -199,6 +199,8 @@ namespace madness {
         static bool truncate_on_project; ///< If true initial projection inserts at n-1 not n
         static bool apply_randomize;   ///< If true use randomization for load balancing in apply integral operator
         static bool project_randomize; ///< If true use randomization for load balancing in project/refine
+        static bool defer_accumulation; ///< If true low rank apply results are summed once in finalize_apply
+        static bool combine_accumulation; ///< If true apply results are summed in thread-local tables before insertion
         static BoundaryConditions<NDIM> bc; ///< Default boundary conditions
         static Tensor<double> cell ;   ///< cell[NDIM][2] Simulation cell, cell(0,0)=xlo, cell(0,1)=xhi, ...
         static Tensor<double> cell_width;///< Width of simulation cell in each dimension
@@ -372,6 +374,34 @@ namespace madness {
         	project_randomize=value;
         }
 
+        /// Gets the flag for deferred accumulation of low rank apply results
+        static bool get_defer_accumulation() {
+        	return defer_accumulation;
+        }
+
+        /// Sets the flag for deferred accumulation of low rank apply results
+
+        /// If set, the low rank results of an apply are collected per node and
+        /// summed with a single recompression in finalize_apply, instead of one
+        /// add_SVD per result.
+        static void set_defer_accumulation(bool value) {
+        	defer_accumulation=value;
+        }
+
+        /// Gets the flag for combining accumulation of full rank apply results
+        static bool get_combine_accumulation() {
+        	return combine_accumulation;
+        }
+
+        /// Sets the flag for combining accumulation of full rank apply results
+
+        /// If set, a fenced apply sums the results for local destination nodes in
+        /// thread-local tables and adds them to the tree in bulk after the fence,
+        /// instead of locking the destination node for every result.
+        static void set_combine_accumulation(bool value) {
+        	combine_accumulation=value;
+        }
+
         /// Returns the default boundary conditions
         static const BoundaryConditions<NDIM>& get_bc() {
         	return bc;
@@ -37,10 +37,15 @@
 
 #include <iostream>
 #include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
 #include <madness/world/MADworld.h>
 #include <madness/world/print.h>
+#include <madness/world/worldcounters.h>
+#include <madness/world/world_topology.h>
 #include <madness/misc/misc.h>
 #include <madness/tensor/tensor.h>
+#include <madness/tensor/tensor_expr.h>
 #include <madness/tensor/gentensor.h>
 
 #include <madness/mra/function_common_data.h>
@@ -134,6 +139,7 @@ namespace madness {
         double _norm_tree; ///< After norm_tree will contain norm of coefficients summed up tree
         bool _has_children; ///< True if there are children
         coeffT buffer; ///< The coefficients, if any
+        std::list<coeffT> addends; ///< deferred addends, summed in consolidate_buffer
         double dnorm=-1.0;	///< norm of the d coefficients
 
     public:
@@ -335,7 +341,21 @@ namespace madness {
         /// Accumulate inplace and if necessary connect node to parent
         void accumulate2(const tensorT& t, const typename FunctionNode<T,NDIM>::dcT& c,
                            const Key<NDIM>& key) {
-            double cpu0=cpu_time();
+            static const Counter ncall("mra.accumulate");
+            ncall += 1;
+            if (accumulate_full(t,key)) {
+                Key<NDIM> parent = key.parent();
+                if (c.is_local(parent))
+                    const_cast<dcT&>(c).send(parent, &FunctionNode<T,NDIM>::set_has_children_recursive, c, parent);
+                else
+                    const_cast<dcT&>(c).task(parent, &FunctionNode<T,NDIM>::set_has_children_recursive, c, parent);
+            }
+        }
+
+        /// Accumulate inplace without connecting the node to its parent
+
+        /// @return true if the node was newly created and its parent must be told that it exists
+        bool accumulate_full(const tensorT& t, const Key<NDIM>& key) {
             if (has_coeff()) {
             	MADNESS_ASSERT(coeff().is_full_tensor());
                 //            	if (coeff().type==TT_FULL) {
@@ -345,29 +365,23 @@ namespace madness {
                 //            		cc += t;
                 //            		coeff()=coeffT(cc,args);
                 //            	}
+                return false;
             }
-            else {
-                // No coeff and no children means the node is newly
-                // created for this operation and therefore we must
-                // tell its parent that it exists.
-            	coeff() = coeffT(t,-1.0,TT_FULL);
-                //                coeff() = copy(t);
-                //                coeff() = coeffT(t,args);
-                if ((!_has_children) && key.level()> 0) {
-                    Key<NDIM> parent = key.parent();
-		    if (c.is_local(parent))
-			const_cast<dcT&>(c).send(parent, &FunctionNode<T,NDIM>::set_has_children_recursive, c, parent);
-		    else
-		      const_cast<dcT&>(c).task(parent, &FunctionNode<T,NDIM>::set_has_children_recursive, c, parent);
-                }
-            }
-            double cpu1=cpu_time();
+            // No coeff and no children means the node is newly
+            // created for this operation and therefore we must
+            // tell its parent that it exists.
+            coeff() = coeffT(t,-1.0,TT_FULL);
+            //                coeff() = copy(t);
+            //                coeff() = coeffT(t,args);
+            return (!_has_children) && key.level()> 0;
         }
 
 
         /// Accumulate inplace and if necessary connect node to parent
         void accumulate(const coeffT& t, const typename FunctionNode<T,NDIM>::dcT& c,
                           const Key<NDIM>& key, const TensorArgs& args) {
+            static const Counter ncall("mra.accumulate");
+            ncall += 1;
             double cpu0=cpu_time();
             if (has_coeff()) {
                 coeff().add_SVD(t,args.thresh);
@@ -396,8 +410,38 @@ namespace madness {
             double cpu1=cpu_time();
         }
 
+        /// Append a low rank addend to this node without adding it yet
+
+        /// The addends are summed with a single recompression in consolidate_buffer,
+        /// instead of one add_SVD per addend as in accumulate. Pays off if a node
+        /// receives many addends, e.g. in the apply of 6D pair functions.
+        void accumulate_deferred(const coeffT& t, const typename FunctionNode<T,NDIM>::dcT& c,
+                          const Key<NDIM>& key) {
+            static const Counter ncall("mra.accumulate_deferred");
+            ncall += 1;
+            if ((not has_coeff()) and addends.empty()) {
+                // the node is newly created for this operation, tell its parent
+                if ((!_has_children) && key.level()> 0) {
+                    Key<NDIM> parent = key.parent();
+                    if (c.is_local(parent))
+                        const_cast<dcT&>(c).send(parent, &FunctionNode<T,NDIM>::set_has_children_recursive, c, parent);
+                    else
+                        const_cast<dcT&>(c).task(parent, &FunctionNode<T,NDIM>::set_has_children_recursive, c, parent);
+                }
+            }
+            addends.push_back(copy(t));
+        }
+
         void consolidate_buffer(const TensorArgs& args) {
-            if ((coeff().has_data()) and (buffer.has_data())) {
+            if (not addends.empty()) {
+                const coeffT first=addends.front();
+                if (coeff().has_data()) addends.push_back(coeff());
+                if (buffer.has_data()) addends.push_back(buffer);
+                coeff()=reduce(addends,args.thresh);
+                addends.clear();
+                // all addends were negligible: keep a zero node so the tree stays consistent
+                if (not coeff().has_data()) coeff()=first*T(0.0);
+            } else if ((coeff().has_data()) and (buffer.has_data())) {
                 coeff().add_SVD(buffer,args.thresh);
             } else if (buffer.has_data()) {
                 coeff()=buffer;
@@ -430,6 +474,124 @@ namespace madness {
     }
 
 
+    /// cheap spatial summary of a function for screening pairs of functions
+
+    /// Holds the bounding box of the significant boxes of a function and a coarse
+    /// occupancy bitmap on a uniform grid of 2^level boxes per dimension, both in
+    /// simulation coordinates [0,1]^NDIM. Two functions whose summaries do not overlap
+    /// have a negligible product.
+    template<std::size_t NDIM>
+    struct SpatialSummary {
+        static constexpr int level=9/NDIM;     ///< at most 512 cells in the occupancy grid
+        static constexpr int nword=8;          ///< number of 64-bit words of the bitmap
+
+        Vector<double,NDIM> lo, hi;             ///< bounding box, empty if lo>hi
+        std::array<uint64_t,nword> bits;        ///< occupancy bitmap
+
+        SpatialSummary() : lo(1.0), hi(0.0) {
+            bits.fill(0);
+        }
+
+        bool empty() const {return lo[0]>hi[0];}
+
+        /// add the box of key to the summary
+        void add_box(const Key<NDIM>& key) {
+            const Level n=key.level();
+            const double h=std::ldexp(1.0,-n);
+            const Vector<Translation,NDIM>& l=key.translation();
+            Vector<Translation,NDIM> clo, chi;      // range of covered cells
+            for (std::size_t d=0; d<NDIM; ++d) {
+                lo[d]=std::min(lo[d],l[d]*h);
+                hi[d]=std::max(hi[d],(l[d]+1)*h);
+                if (n>=level) {
+                    clo[d]=chi[d]=(l[d]>>(n-level));
+                } else {
+                    clo[d]=l[d]<<(level-n);
+                    chi[d]=((l[d]+1)<<(level-n))-1;
+                }
+            }
+            Vector<Translation,NDIM> c=clo;
+            while (true) {
+                long index=0;
+                for (std::size_t d=0; d<NDIM; ++d) index=(index<<level)+c[d];
+                bits[index/64] |= (uint64_t(1)<<(index%64));
+                std::size_t d=0;
+                for (; d<NDIM; ++d) {
+                    if (++c[d]<=chi[d]) break;
+                    c[d]=clo[d];
+                }
+                if (d==NDIM) break;
+            }
+        }
+
+        /// check if the significant regions of two functions overlap
+        bool overlaps(const SpatialSummary& other) const {
+            if (empty() or other.empty()) return false;
+            for (std::size_t d=0; d<NDIM; ++d) {
+                if (hi[d]<other.lo[d] or other.hi[d]<lo[d]) return false;
+            }
+            for (int i=0; i<nword; ++i) if (bits[i] & other.bits[i]) return true;
+            return false;
+        }
+    };
+
+
+    /// thread-local partial sums of full-rank apply results, keyed by destination node
+
+    /// In 3D applies many tasks accumulate into the same few destination nodes, each
+    /// taking the write lock of the node. With combining, every pool thread sums its
+    /// contributions into its own table instead, and the tables are added to the tree
+    /// once after all contributions are in (FunctionImpl::flush_combined_accumulation).
+    /// Threads not in the pool share one table protected by a spinlock.
+    template<typename T, std::size_t NDIM>
+    class AccumulationCombiner {
+    public:
+        typedef Key<NDIM> keyT;
+        typedef Tensor<T> tensorT;
+        typedef std::unordered_map<keyT,tensorT,Hash<keyT> > tableT;
+
+    private:
+        /// one table per thread, padded to avoid false sharing between the threads
+        struct alignas(64) slotT {
+            tableT table;
+        };
+        std::vector<slotT> slots;       ///< slot 0 for non-pool threads, i+1 for pool thread i
+        Spinlock slot0_lock;
+
+    public:
+        AccumulationCombiner() : slots(ThreadPool::size()+1) {}
+
+        AccumulationCombiner(const AccumulationCombiner&) = delete;
+        AccumulationCombiner& operator=(const AccumulationCombiner&) = delete;
+
+        /// add t to the partial sum of the calling thread for node key
+        void add(const keyT& key, const tensorT& t) {
+            static const Counter ncall("mra.accumulate_combined");
+            ncall += 1;
+            const ThreadBase* thread=ThreadBase::this_thread();
+            const int islot= thread ? thread->get_pool_thread_index()+1 : 0;
+            if (islot>0) {
+                add_to(slots[islot].table, key, t);
+            } else {
+                ScopedMutex<Spinlock> lock(slot0_lock);
+                add_to(slots[0].table, key, t);
+            }
+        }
+
+        std::size_t nslot() const {return slots.size();}
+
+        /// the partial sums of one thread; only to be used once all contributions are in
+        const tableT& table(std::size_t islot) const {return slots[islot].table;}
+
+    private:
+        static void add_to(tableT& table, const keyT& key, const tensorT& t) {
+            auto it=table.find(key);
+            if (it==table.end()) table.emplace(key,copy(t));
+            else it->second+=t;
+        }
+    };
+
+
     /// returns true if the result of a hartree_product is a leaf node (compute norm & error)
     template<typename T, size_t NDIM>
     struct hartree_leaf_op {
@@ -897,6 +1059,9 @@ namespace madness {
 
         dcT coeffs; ///< The coefficients
 
+        /// partial sums of apply results while combining is active (see apply), null otherwise
+        std::atomic<AccumulationCombiner<T,NDIM>*> combiner{nullptr};
+
         // Disable the default copy constructor
         FunctionImpl(const FunctionImpl<T,NDIM>& p);
 
@@ -1008,12 +1173,77 @@ namespace madness {
             this->process_pending();
         }
 
-        virtual ~FunctionImpl() { }
+        virtual ~FunctionImpl() {
+            delete combiner.load();
+        }
 
         const std::shared_ptr< WorldDCPmapInterface< Key<NDIM> > >& get_pmap() const;
 
+        /// gives every process a copy of all nodes
+
+        /// With a NodeTopology the processes of a node share one copy of the
+        /// coefficients, see replicate_on_node.
         void replicate(bool fence=true) {
-        	coeffs.replicate(fence);
+            const NodeTopology* topology = world.node_topology();
+            if (topology and can_pack_nodes()) replicate_on_node(*topology, fence);
+            else coeffs.replicate(fence);
+        }
+
+        /// the local nodes packed into a slab, see pack_local_nodes
+        std::vector<unsigned char> local_slab() const {
+            std::vector<unsigned char> v;
+            pack_local_nodes(v);
+            return v;
+        }
+
+        /// replicates the nodes, keeping the coefficients once per node in shared memory
+
+        /// The leader of each node collects the nodes of every process as a
+        /// slab (see pack_local_nodes) into a NodeSharedMemory, and all
+        /// processes of the node insert views of the coefficients.
+        /// The memory is mapped copy-on-write, so changing the coefficients
+        /// on one process does not change them on the others.
+        void replicate_on_node(const NodeTopology& topology, bool fence=true) {
+            world.gop.fence();      // all updates of the coefficients must have completed
+
+            // the leaders fetch all slabs
+            std::vector<std::vector<unsigned char> > all;
+            if (topology.is_leader()) {
+                std::vector<Future<std::vector<unsigned char> > > slabs;
+                for (ProcessID r = 0; r < world.size(); ++r) slabs.push_back(woT::task(r, &implT::local_slab));
+                for (ProcessID r = 0; r < world.size(); ++r) all.push_back(slabs[r].get());
+            }
+
+            // segment: the number of slabs, the position and size of each, then the slabs
+            auto pad = [](std::size_t n) {return (n + 15) & ~std::size_t(15);};
+            const std::uint64_t nslab = all.size();
+            std::vector<std::uint64_t> index(1 + 2*nslab);
+            index[0] = nslab;
+            std::size_t size = pad(index.size()*sizeof(std::uint64_t));
+            for (std::size_t i = 0; i < nslab; ++i) {
+                index[1 + 2*i] = size;
+                index[2 + 2*i] = all[i].size();
+                size = pad(size + all[i].size());
+            }
+            auto fill = [&](unsigned char* p) {
+                std::memcpy(p, index.data(), index.size()*sizeof(std::uint64_t));
+                for (std::size_t i = 0; i < nslab; ++i) {
+                    if (all[i].size()) std::memcpy(p + index[1 + 2*i], all[i].data(), all[i].size());
+                }
+            };
+            auto shared = std::make_shared<NodeSharedMemory>(topology, size, fill);
+            all.clear();
+
+            coeffs.make_pmap_local();
+            unsigned char* p = shared->data();
+            std::uint64_t n = 0;
+            std::memcpy(&n, p, sizeof(n));
+            for (std::uint64_t i = 0; i < n; ++i) {
+                std::uint64_t pos[2];
+                std::memcpy(pos, p + (1 + 2*i)*sizeof(std::uint64_t), sizeof(pos));
+                unpack_nodes(p + pos[0], pos[1], 0, shared);
+            }
+            if (fence) world.gop.fence();
         }
 
         void distribute(std::shared_ptr< WorldDCPmapInterface< Key<NDIM> > > newmap) const {
@@ -1128,9 +1358,7 @@ namespace madness {
 
             MADNESS_ASSERT(kk==k);
 
-            // note that functor should not be (re)stored
-            ar & thresh & initial_level & max_refine_level & truncate_mode
-                & autorefine & truncate_on_project & tree_state;//nonstandard & compressed ; //& bc;
+            load_metadata(ar);
 
             ar & coeffs;
             world.gop.fence();
@@ -1141,13 +1369,145 @@ namespace madness {
         template <typename Archive>
         void store(Archive& ar) {
             // WE RELY ON K BEING STORED FIRST
+            ar & k;
+            store_metadata(ar);
 
+            ar & coeffs;
+            world.gop.fence();
+        }
+
+        /// loads the parameters of the function impl (everything stored by store_metadata)
+        template <typename Archive>
+        void load_metadata(Archive& ar) {
             // note that functor should not be (re)stored
-            ar & k & thresh & initial_level & max_refine_level & truncate_mode
+            ar & thresh & initial_level & max_refine_level & truncate_mode
                 & autorefine & truncate_on_project & tree_state;//nonstandard & compressed ; //& bc;
+        }
 
-            ar & coeffs;
-            world.gop.fence();
+        /// stores the parameters of the function impl except k, but not the coefficients
+        template <typename Archive>
+        void store_metadata(Archive& ar) const {
+            ar & thresh & initial_level & max_refine_level & truncate_mode
+                & autorefine & truncate_on_project & tree_state;
+        }
+
+        /// index entry of a node in a slab, see pack_local_nodes
+        struct SlabEntry {
+            Level n;
+            Translation l[NDIM];
+            long dim[NDIM];
+            long ndim;              ///< -1 if the node has no coefficients
+            double norm_tree;
+            double dnorm;
+            std::uint64_t offset;   ///< of the coefficients, relative to the start of the slab
+            bool has_children;
+        };
+
+        /// true if the coefficients can be packed into slabs (they have full rank)
+        bool can_pack_nodes() const {
+            return get_tensor_type() == TT_FULL;
+        }
+
+        /// appends the locally owned nodes to a byte buffer ("slab")
+
+        /// The slab starts at the current end of \c v, which must be a multiple
+        /// of 16 bytes from the start of \c v.  It holds the number of nodes, an
+        /// array of \c SlabEntry and then the coefficients of all nodes, each
+        /// contiguous and starting at a multiple of 16 bytes from the start of
+        /// \c v.  Only full-rank coefficients are supported.  No fence.
+        void pack_local_nodes(std::vector<unsigned char>& v) const {
+            auto pad = [](std::size_t n) {return (n + 15) & ~std::size_t(15);};
+            const std::size_t start = v.size();
+            MADNESS_CHECK(start % 16 == 0);
+            const std::uint64_t nnode = coeffs.size();
+
+            std::vector<SlabEntry> entries;
+            entries.reserve(nnode);
+            std::size_t offset = pad(start + sizeof(nnode) + nnode*sizeof(SlabEntry));
+            for (auto it = coeffs.begin(); it != coeffs.end(); ++it) {
+                const keyT& key = it->first;
+                const nodeT& node = it->second;
+                SlabEntry e;
+                e.n = key.level();
+                for (std::size_t d = 0; d < NDIM; ++d) e.l[d] = key.translation()[d];
+                e.ndim = -1;
+                e.norm_tree = node.get_norm_tree();
+                e.dnorm = node.get_dnorm();
+                e.offset = offset;
+                e.has_children = node.has_children();
+                if (node.has_coeff()) {
+                    MADNESS_CHECK(node.coeff().is_full_tensor());
+                    const tensorT& t = node.coeff().full_tensor();
+                    e.ndim = t.ndim();
+                    for (long d = 0; d < t.ndim(); ++d) e.dim[d] = t.dim(d);
+                    offset = pad(offset + t.size()*sizeof(T));
+                }
+                entries.push_back(e);
+            }
+
+            v.resize(offset);
+            std::memcpy(&v[start], &nnode, sizeof(nnode));
+            if (nnode) std::memcpy(&v[start + sizeof(nnode)], entries.data(), nnode*sizeof(SlabEntry));
+            auto e = entries.begin();
+            for (auto it = coeffs.begin(); it != coeffs.end(); ++it, ++e) {
+                if (e->ndim < 0) continue;
+                tensorT t = it->second.coeff().full_tensor();
+                if (not t.iscontiguous()) t = copy(t);
+                std::memcpy(&v[e->offset], t.ptr(), t.size()*sizeof(T));
+            }
+        }
+
+        /// inserts the nodes of a slab made by pack_local_nodes
+
+        /// The coefficients of nodes owned by this process are views into
+        /// \c slab (no copy); other nodes are sent to their owners.  No fence.
+        /// @param[in] slab     the buffer holding the slab, kept alive by the views
+        /// @param[in] start    position of the slab in the buffer
+        void unpack_nodes(const std::shared_ptr<std::vector<unsigned char>>& slab, std::size_t start) {
+            unpack_nodes(slab->data(), slab->size(), start, slab);
+        }
+
+        /// inserts the nodes of a slab held in memory owned by another object, e.g. a NodeSharedMemory
+
+        /// Same as above, the offsets in the slab are relative to \c v.
+        /// @param[in] v        the buffer holding the slab, 16-byte aligned
+        /// @param[in] size     size of the buffer
+        /// @param[in] start    position of the slab in the buffer
+        /// @param[in] owner    owner of the buffer, kept alive by the views
+        template <typename ownerT>
+        void unpack_nodes(unsigned char* v, std::size_t size, std::size_t start, const std::shared_ptr<ownerT>& owner) {
+            std::uint64_t nnode = 0;
+            MADNESS_CHECK(start + sizeof(nnode) <= size);
+            std::memcpy(&nnode, &v[start], sizeof(nnode));
+            MADNESS_CHECK(start + sizeof(nnode) + nnode*sizeof(SlabEntry) <= size);
+            for (std::uint64_t i = 0; i < nnode; ++i) {
+                SlabEntry e;
+                std::memcpy(&e, &v[start + sizeof(nnode) + i*sizeof(SlabEntry)], sizeof(SlabEntry));
+                Vector<Translation,NDIM> l;
+                for (std::size_t d = 0; d < NDIM; ++d) l[d] = e.l[d];
+                const keyT key(e.n, l);
+
+                coeffT c;
+                if (e.ndim >= 0) {
+                    tensorT t(e.ndim, e.dim, reinterpret_cast<T*>(&v[e.offset]), owner);
+                    MADNESS_CHECK(e.offset + t.size()*sizeof(T) <= size);
+                    c = coeffT(t, get_tensor_args());
+                }
+                if (coeffs.is_local(key)) {
+                    // assign the shallow coefficients, nodeT's copy assignment would deep copy
+                    typename dcT::accessor acc;
+                    coeffs.insert(acc, key);
+                    acc->second.coeff() = c;
+                    acc->second.set_has_children(e.has_children);
+                    acc->second.set_norm_tree(e.norm_tree);
+                    acc->second.set_dnorm(e.dnorm);
+                }
+                else {
+                    nodeT node(c, e.norm_tree, e.has_children);
+                    node.set_dnorm(e.dnorm);
+                    coeffs.replace(key, node);
+                }
+            }
         }
 
         /// Returns true if the function is compressed.
@@ -4511,6 +4871,7 @@ namespace madness {
             // and also to ensure we don't needlessly widen the tree when
             // applying the operator
             if (result.normf()> 0.3*args.tol/args.fac) {
+                count_bytes_sent(args.dest, result.size()*sizeof(T));
                 coeffs.task(args.dest, &nodeT::accumulate2, result, coeffs, args.dest, TaskAttributes::hipri());
                 //woT::task(world.rank(),&implT::accumulate_timer,time,TaskAttributes::hipri());
                 // UGLY BUT ADDED THE OPTIMIZATION BACK IN HERE EXPLICITLY/
@@ -4551,11 +4912,12 @@ namespace madness {
                 //double cpu1=cpu_time();
                 //timer_lr_result.accumulate(cpu1-cpu0);
 
-                coeffs.task(args.dest, &nodeT::accumulate, result, coeffs, args.dest, apply_targs,
-                                                TaskAttributes::hipri());
+                count_bytes_sent(args.dest, result.real_size()*sizeof(T));
+                accumulate_result(args.dest, result, apply_targs);
 
                 //woT::task(world.rank(),&implT::accumulate_timer,time,TaskAttributes::hipri());
             }
+            else apply_counters().result_screened += 1;
             return norm;
         }
 
@@ -4589,44 +4951,66 @@ namespace madness {
                 timer_lr_result.accumulate(cpu1-cpu0);
 
                 // accumulate also expects result in SVD form
-                coeffs.task(args.dest, &nodeT::accumulate, result, coeffs, args.dest, apply_targs,
-                                                TaskAttributes::hipri());
+                count_bytes_sent(args.dest, result.real_size()*sizeof(T));
+                accumulate_result(args.dest, result, apply_targs);
 //                woT::task(world.rank(),&implT::accumulate_timer,time,TaskAttributes::hipri());
 
             }
+            else apply_counters().result_screened += 1;
             return result_norm;
 
         }
 
+        /// hot-path counters of the apply kernels, see worldcounters.h
+        struct ApplyCounters {
+            Counter tried;              ///< displacements considered
+            Counter screened;           ///< displacements skipped by the norm estimate
+            Counter result_screened;    ///< results computed but discarded as negligible
+            CounterArray bytes_sent;    ///< bytes of results sent to other processes, per level of the target
+            ApplyCounters() : tried("mra.apply.displacements_tried"),
+                    screened("mra.apply.displacements_screened"),
+                    result_screened("mra.apply.results_screened"),
+                    bytes_sent("mra.apply.bytes_sent_level", 32) {}
+        };
+
+        static const ApplyCounters& apply_counters() {
+            static const ApplyCounters counters;
+            return counters;
+        }
+
+        /// add a low rank apply result to the destination node, possibly deferred
+        void accumulate_result(const keyT& dest, const coeffT& result, const TensorArgs& apply_targs) {
+            if (FunctionDefaults<NDIM>::get_defer_accumulation() and result.is_svd_tensor()) {
+                coeffs.task(dest, &nodeT::accumulate_deferred, result, coeffs, dest, TaskAttributes::hipri());
+            } else {
+                coeffs.task(dest, &nodeT::accumulate, result, coeffs, dest, apply_targs, TaskAttributes::hipri());
+            }
+        }
+
+        /// count the bytes of an apply result if it will be sent to another process
+        void count_bytes_sent(const keyT& dest, const std::size_t nbyte) const {
+            if (not coeffs.is_local(dest)) apply_counters().bytes_sent.add(dest.level(), nbyte);
+        }
+
         // volume of n-dimensional sphere of radius R
         double vol_nsphere(int n, double R) {
             return std::pow(madness::constants::pi,n*0.5)*std::pow(R,n)/std::tgamma(1+0.5*n);
         }
         
 
-        /// apply an operator on the coeffs c (at node key)
+        /// call fn(disp, dest, tol) for each displacement of the source box key that passes the screening
 
-        /// the result is accumulated inplace to this's tree at various FunctionNodes
+        /// tol is the tolerance of the result of one displacement
         /// @param[in] op	the operator to act on the source function
-        /// @param[in] key	key of the source FunctionNode of f which is processed
-        /// @param[in] c	coeffs of the FunctionNode of f which is processed
-        template <typename opT, typename R>
-        void do_apply(const opT* op, const keyT& key, const Tensor<R>& c) {
-            PROFILE_MEMBER_FUNC(FunctionImpl);
-
-	    // working assumption here WAS that the operator is
-	    // isotropic and montonically decreasing with distance
-	    // ... however, now we are using derivative Gaussian
-	    // expansions (and also non-cubic boxes) isotropic is
-	    // violated. While not strictly monotonically decreasing,
-	    // the derivative gaussian is still such that once it
-	    // becomes negligible we are in the asymptotic region.
-
+        /// @param[in] key	key of the source box
+        /// @param[in] cnorm	norm of the coeffs of the source box
+        /// @param[in] count	count the screened displacements in apply_counters()
+        template <typename opT, typename fnT>
+        void foreach_screened_displacement(const opT* op, const keyT& key, const double cnorm,
+                fnT fn, const bool count=true) {
             typedef typename opT::keyT opkeyT;
             static const size_t opdim=opT::opdim;
-            const opkeyT source=op->get_source_key(key);
 
-            
             // Tuning here is based on observation that with
             // sufficiently high-order wavelet relative to the
             // precision, that only nearest neighbor boxes contribute,
@@ -4647,56 +5031,108 @@ namespace madness {
             double fac = vol_nsphere(NDIM, radius);
             //previously fac=10.0 selected empirically constrained by qmprop
 
-            double cnorm = c.normf();
+            const double tol = truncate_tol(thresh, key);
 
-            const std::vector<opkeyT>& disp = op->get_disp(key.level()); // list of displacements sorted in orer of increasing distance
+            // the displacements sorted by decreasing operator norm: once one
+            // of them is screened, all remaining ones are screened as well
+            const auto& table = op->get_screened_disp(key.level());
             const std::vector<bool> is_periodic(NDIM,false); // Periodic sum is already done when making rnlp
-	    int ndone=1;	// Counts #done at each distance
-	    uint64_t distsq = 99999999999999; 
-            for (typename std::vector<opkeyT>::const_iterator it=disp.begin(); it != disp.end(); ++it) {
-	        keyT d;
-                Key<NDIM-opdim> nullkey(key.level());
-                if (op->particle()==1) d=it->merge_with(nullkey);
-                if (op->particle()==2) d=nullkey.merge_with(*it);
-
-		uint64_t dsq = d.distsq();
-		if (dsq != distsq) { // Moved to next shell of neighbors
-		    if (ndone == 0 && dsq > 1) {
-		        // Have at least done the input box and all first
-		        // nearest neighbors, and for all of the last set
-		        // of neighbors had no contribution.  Thus,
-		        // assuming monotonic decrease, we are done.
-		        break;
-		    }
-		    ndone = 0;
-		    distsq = dsq;
-		} 
+            const Key<NDIM-opdim> nullkey(key.level());
+            for (std::size_t i=0; i<table.disp.size(); ++i) {
+                if (cnorm*table.norm[i] <= tol/fac) {
+                    if (count) {
+                        apply_counters().tried += 1;
+                        apply_counters().screened += 1;
+                    }
+                    break;
+                }
+
+                const opkeyT& disp = table.disp[i];
+                keyT d;
+                if (op->particle()==1) d=disp.merge_with(nullkey);
+                if (op->particle()==2) d=nullkey.merge_with(disp);
 
                 keyT dest = neighbor(key, d, is_periodic);
-                if (dest.is_valid()) {
-                    double opnorm = op->norm(key.level(), *it, source);
-                    double tol = truncate_tol(thresh, key);
+                if (not dest.is_valid()) continue;
+                fn(disp, dest, tol/fac);
+            }
+        }
 
-                    if (cnorm*opnorm> tol/fac) {
-		        ndone++;
-		        tensorT result = op->apply(source, *it, c, tol/fac/cnorm);
-			if (result.normf() > 0.3*tol/fac) {
-			  if (coeffs.is_local(dest))
-			      coeffs.send(dest, &nodeT::accumulate2, result, coeffs, dest);
-			  else
-  			      coeffs.task(dest, &nodeT::accumulate2, result, coeffs, dest);
-                        }
-                    }
-                }
+        /// add the result of the apply of one displacement to the node dest
+        void add_apply_result(const keyT& dest, const tensorT& result) {
+            count_bytes_sent(dest, result.size()*sizeof(T));
+            AccumulationCombiner<T,NDIM>* comb=combiner.load(std::memory_order_acquire);
+            if (comb and coeffs.is_local(dest))
+                comb->add(dest, result);
+            else if (coeffs.is_local(dest))
+                coeffs.send(dest, &nodeT::accumulate2, result, coeffs, dest);
+            else
+                coeffs.task(dest, &nodeT::accumulate2, result, coeffs, dest);
+        }
+
+        /// apply an operator on the coeffs c (at node key)
+
+        /// the result is accumulated inplace to this's tree at various FunctionNodes
+        /// @param[in] op	the operator to act on the source function
+        /// @param[in] key	key of the source FunctionNode of f which is processed
+        /// @param[in] c	coeffs of the FunctionNode of f which is processed
+        template <typename opT, typename R>
+        void do_apply(const opT* op, const keyT& key, const Tensor<R>& c) {
+            PROFILE_MEMBER_FUNC(FunctionImpl);
+            typedef typename opT::keyT opkeyT;
+            const opkeyT source=op->get_source_key(key);
+            const double cnorm = c.normf();
+
+            foreach_screened_displacement(op, key, cnorm, [&](const opkeyT& disp, const keyT& dest, const double tol) {
+                apply_counters().tried += 1;
+                tensorT result = op->apply(source, disp, c, tol/cnorm);
+                if (result.normf() > 0.3*tol) add_apply_result(dest, result);
+                else apply_counters().result_screened += 1;
+            });
+        }
+
+        /// apply an operator on the coeffs c (at node key), only for the destinations owned by this process
+
+        /// see apply_owner_computes
+        template <typename opT, typename R>
+        void do_apply_owned(const opT* op, const keyT& key, const Tensor<R>& c) {
+            PROFILE_MEMBER_FUNC(FunctionImpl);
+            typedef typename opT::keyT opkeyT;
+            const opkeyT source=op->get_source_key(key);
+            const double cnorm = c.normf();
+
+            foreach_screened_displacement(op, key, cnorm, [&](const opkeyT& disp, const keyT& dest, const double tol) {
+                if (not coeffs.is_local(dest)) return;
+                apply_counters().tried += 1;
+                tensorT result = op->apply(source, disp, c, tol/cnorm);
+                if (result.normf() > 0.3*tol) add_apply_result(dest, result);
+                else apply_counters().result_screened += 1;
+            });
+        }
+
+        /// apply an operator on the source nodes that were sent to this process, see apply_owner_computes
+        template <typename opT, typename R>
+        void apply_owned_sources(const opT* op, const std::vector<keyT>& keys, const std::vector< Tensor<R> >& c) {
+            for (std::size_t i=0; i<keys.size(); ++i) {
+                woT::task(world.rank(), &implT:: template do_apply_owned<opT,R>, op, keys[i], c[i]);
             }
         }
 
 
         /// apply an operator on f to return this
+
+        /// If FunctionDefaults::get_combine_accumulation() is set and fence is true,
+        /// contributions to local nodes are summed in thread-local tables and added
+        /// to the tree in bulk after the fence (see AccumulationCombiner).
         template <typename opT, typename R>
         void apply(opT& op, const FunctionImpl<R,NDIM>& f, bool fence) {
             PROFILE_MEMBER_FUNC(FunctionImpl);
             MADNESS_ASSERT(!op.modified());
+            const bool combine=fence and FunctionDefaults<NDIM>::get_combine_accumulation();
+            if (combine) {
+                MADNESS_ASSERT(combiner.load()==nullptr);
+                combiner.store(new AccumulationCombiner<T,NDIM>(), std::memory_order_release);
+            }
             typename dcT::const_iterator end = f.coeffs.end();
             for (typename dcT::const_iterator it=f.coeffs.begin(); it!=end; ++it) {
                 // looping through all the coefficients in the source
@@ -4712,6 +5148,7 @@ namespace madness {
             }
             if (fence)
                 world.gop.fence();
+            if (combine) flush_combined_accumulation();
 
             set_tree_state(nonstandard);
 //            this->compressed=true;
@@ -4720,7 +5157,105 @@ namespace madness {
 
         }
 
+        /// apply an operator on f to return this, each process computing the results in its own boxes
 
+        /// Instead of sending each result to the owner of its destination, as
+        /// apply does, each process sends every one of its source nodes once to
+        /// each process that owns a destination of the source, in one message
+        /// per process.  The owners then compute all results for their boxes and
+        /// accumulate them locally.  This trades the results of all displacements
+        /// for one copy of the source per owner.  Selected with
+        /// SeparatedConvolution::owner_computes().
+        template <typename opT, typename R>
+        void apply_owner_computes(opT& op, const FunctionImpl<R,NDIM>& f, bool fence) {
+            PROFILE_MEMBER_FUNC(FunctionImpl);
+            MADNESS_ASSERT(!op.modified());
+            typedef typename opT::keyT opkeyT;
+            const bool combine=fence and FunctionDefaults<NDIM>::get_combine_accumulation();
+            if (combine) {
+                MADNESS_ASSERT(combiner.load()==nullptr);
+                combiner.store(new AccumulationCombiner<T,NDIM>(), std::memory_order_release);
+            }
+
+            // the source nodes needed by each process
+            std::vector< std::vector<keyT> > keys(world.size());
+            std::vector< std::vector< Tensor<R> > > sources(world.size());
+            std::vector<ProcessID> owners;
+            typename FunctionImpl<R,NDIM>::dcT::const_iterator end = f.coeffs.end();
+            for (typename FunctionImpl<R,NDIM>::dcT::const_iterator it=f.coeffs.begin(); it!=end; ++it) {
+                const keyT& key = it->first;
+                const FunctionNode<R,NDIM>& node = it->second;
+                if (node.has_coeff() and (node.coeff().dim(0) != k || op.doleaves)) {
+                    const Tensor<R> c=node.coeff().reconstruct_tensor();
+                    owners.clear();
+                    foreach_screened_displacement(&op, key, c.normf(), [&](const opkeyT& disp, const keyT& dest, const double tol) {
+                        const ProcessID p=coeffs.owner(dest);
+                        if (std::find(owners.begin(),owners.end(),p)==owners.end()) owners.push_back(p);
+                    }, false);
+                    for (ProcessID p : owners) {
+                        if (p==world.rank()) {
+                            woT::task(p, &implT:: template do_apply_owned<opT,R>, &op, key, c);
+                        } else {
+                            keys[p].push_back(key);
+                            sources[p].push_back(c);
+                            apply_counters().bytes_sent.add(key.level(), c.size()*sizeof(R));
+                        }
+                    }
+                }
+            }
+            for (ProcessID p=0; p<world.size(); ++p) {
+                if (keys[p].size()) woT::task(p, &implT:: template apply_owned_sources<opT,R>, &op, keys[p], sources[p]);
+            }
+
+            if (fence)
+                world.gop.fence();
+            if (combine) flush_combined_accumulation();
+
+            set_tree_state(nonstandard);
+        }
+
+
+
+        /// add the thread-local partial sums of the apply results to the tree
+
+        /// Must be called collectively after a fence that completes all contributions.
+        /// The destination keys are partitioned by their hash over one task per thread,
+        /// and each task sums the contributions of all tables to its keys, so every node
+        /// is locked exactly once. New nodes are linked to their parents with one message
+        /// per distinct parent and task. Fences.
+        void flush_combined_accumulation() {
+            AccumulationCombiner<T,NDIM>* comb=combiner.exchange(nullptr);
+            if (comb) {
+                const std::size_t npart=comb->nslot();
+                for (std::size_t ipart=0; ipart<npart; ++ipart)
+                    world.taskq.add(*this, &implT::add_combined_partition, comb, ipart, npart);
+            }
+            world.gop.fence();
+            delete comb;
+        }
+
+        /// add the partial sums of all tables for the keys in one partition to the (local) nodes of the tree
+        void add_combined_partition(const AccumulationCombiner<T,NDIM>* comb, std::size_t ipart,
+                                    std::size_t npart) {
+            static const Counter nnode("mra.accumulate_combined_nodes");
+            std::unordered_set<keyT,Hash<keyT> > parents;
+            for (std::size_t islot=0; islot<comb->nslot(); ++islot) {
+                for (const auto& datum : comb->table(islot)) {
+                    if (datum.first.hash()%npart != ipart) continue;
+                    nnode += 1;
+                    typename dcT::accessor acc;
+                    coeffs.insert(acc,datum.first);
+                    if (acc->second.accumulate_full(datum.second,datum.first))
+                        parents.insert(datum.first.parent());
+                }
+            }
+            for (const keyT& parent : parents) {
+                if (coeffs.is_local(parent))
+                    coeffs.send(parent, &nodeT::set_has_children_recursive, coeffs, parent);
+                else
+                    coeffs.task(parent, &nodeT::set_has_children_recursive, coeffs, parent);
+            }
+        }
 
         /// apply an operator on the coeffs c (at node key)
 
@@ -4788,6 +5323,7 @@ namespace madness {
                 keyT dest = neighbor(key, disp1, is_periodic);
 
                 if (not dest.is_valid()) continue;
+                apply_counters().tried += 1;
 
                 // directed screening
                 // working assumption here is that the operator is isotropic and
@@ -4829,9 +5365,14 @@ namespace madness {
                         }
 
                     } else if (shell >= 12) {
+                        apply_counters().screened += 1;
                         break; // Assumes monotonic decay beyond nearest neighbor
+                    } else {
+                        apply_counters().screened += 1;
                     }
                     if (norm<0.3*tol/fac) blacklist.push_back(d);
+                } else {
+                    apply_counters().screened += 1;
                 }
             }
             return maxnorm;
@@ -5227,6 +5768,22 @@ namespace madness {
         /// Returns the square of the local norm ... no comms
         double norm2sq_local() const;
 
+        /// Returns the local part of the spatial summary of this function ... no comms
+
+        /// Includes all boxes with coefficients whose norm exceeds tol: the leaf boxes
+        /// if reconstructed, all boxes otherwise.
+        SpatialSummary<NDIM> local_spatial_summary(const double tol) const {
+            SpatialSummary<NDIM> summary;
+            const bool leaves_only=is_reconstructed();
+            for (typename dcT::const_iterator it=coeffs.begin(); it!=coeffs.end(); ++it) {
+                const nodeT& node=it->second;
+                if (not node.has_coeff()) continue;
+                if (leaves_only and node.has_children()) continue;
+                if (node.coeff().normf()>tol) summary.add_box(it->first);
+            }
+            return summary;
+        }
+
         /// compute the inner product of this range with other
         template<typename R>
         struct do_inner_local {
@@ -5887,7 +6444,7 @@ namespace madness {
                     const tensorT other_tensor=fcoeff.get_svdtensor().ref_vector(otherdim)(other_s).reshape(k,k,k);
                     const double ovlp= gtensor.trace_conj(contracted_tensor);
                     const double fac=ovlp * fcoeff.get_svdtensor().weights(r);
-                    final+=fac*other_tensor;
+                    accumulate(final, expr(other_tensor)*fac);
                 }
 
                 // accumulate the result
@@ -6014,7 +6571,7 @@ namespace madness {
                 const tensorT other_tensor=fcoeff.config().ref_vector(otherdim)(s).reshape(k,k,k);
                 const double ovlp= gtensor.trace_conj(contracted_tensor);
                 const double fac=ovlp * fcoeff.config().weights(r);
-                result+=fac*other_tensor;
+                accumulate(result, expr(other_tensor)*fac);
             }
 
             // accumulate the result
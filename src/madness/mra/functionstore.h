@@ -0,0 +1,273 @@
+/*
+  This file is part of MADNESS.
+
+  Copyright (C) 2007,2010 Oak Ridge National Laboratory
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+
+  For more information please contact:
+
+  Robert J. Harrison
+  Oak Ridge National Laboratory
+  One Bethel Valley Road
+  P.O. Box 2008, MS-6367
+
+  email: harrisonrj@ornl.gov
+  tel:   865-241-3937
+  fax:   865-572-0680
+*/
+
+#ifndef MADNESS_MRA_FUNCTIONSTORE_H__INCLUDED
+#define MADNESS_MRA_FUNCTIONSTORE_H__INCLUDED
+
+/// \file functionstore.h
+/// \brief A keyed store of Functions that keeps only a bounded amount of them in memory
+
+#include <madness/mra/mra.h>
+#include <madness/world/parallel_dc_archive.h>
+#include <cstdio>
+#include <fstream>
+#include <map>
+
+namespace madness {
+
+    /// A keyed store of Functions, e.g. the 6D pair functions of MP2 or CC2
+
+    /// Functions not used for a while are evicted to a scratch file, one
+    /// per process, so that the coefficients held by the store stay below a
+    /// budget.  Each process writes its own nodes as one blob (see
+    /// FunctionImpl::pack_local_nodes), compressed if that makes it smaller,
+    /// into a slot of its file; nothing is communicated.  An evicted Function
+    /// is read back on the next get(), or in the background after prefetch().
+    ///
+    /// All member functions are collective on the world and must be called
+    /// in the same order on all processes.  The Functions returned by get()
+    /// are shallow copies: changes must be put back with set(), and memory
+    /// is only released once the caller drops its copy of an evicted Function.
+    /// \tparam keyT a key with \c operator<, e.g. \c std::pair<int,int>
+    template <typename keyT, typename T, std::size_t NDIM>
+    class FunctionStore {
+    public:
+        typedef Function<T,NDIM> functionT;
+
+    private:
+        /// a Function and its copy in the scratch file
+        struct Entry {
+            functionT f;                    ///< the Function if resident, otherwise empty
+            double bytes = 0.0;             ///< size of the coefficients per process, if resident
+            std::vector<unsigned char> metadata;    ///< k and the parameters of the FunctionImpl
+            std::uint64_t offset = 0;       ///< slot of the blob of this process in the file
+            std::uint64_t capacity = 0;     ///< size of the slot
+            std::uint64_t length = 0;       ///< size of the blob, 0 if not written
+            bool dirty = true;              ///< resident and not identical to the blob
+            long last_use = 0;
+            std::shared_ptr<Future<std::vector<unsigned char> > > prefetched;   ///< blob being read, if any
+        };
+
+        World& world;
+        std::string filename;           ///< scratch file of this process
+        double budget;                  ///< bytes of coefficients per process kept in memory
+        std::map<keyT,Entry> entries;
+        mutable std::fstream file;
+        std::uint64_t file_end = 0;
+        long clock = 0;
+        mutable Mutex file_mutex;       ///< the file is read by prefetch tasks
+
+        FunctionStore(const FunctionStore&) = delete;
+        FunctionStore& operator=(const FunctionStore&) = delete;
+
+    public:
+        /// @param[in] world    the world of the Functions
+        /// @param[in] prefix   prefix of the scratch files, followed by the rank (best on a local disk)
+        /// @param[in] budget   bytes of coefficients per process kept in memory
+        FunctionStore(World& world, const std::string& prefix, const double budget)
+            : world(world), budget(budget) {
+            char buf[16];
+            snprintf(buf, sizeof(buf), ".%5.5d", world.rank());
+            filename = prefix + buf;
+            file.open(filename.c_str(), std::ios::in | std::ios::out | std::ios::trunc | std::ios::binary);
+            if (not file) MADNESS_EXCEPTION(("FunctionStore: cannot open " + filename).c_str(), 1);
+        }
+
+        ~FunctionStore() {
+            for (auto& e : entries) if (e.second.prefetched) e.second.prefetched->get();
+            file.close();
+            std::remove(filename.c_str());
+        }
+
+        /// true if there is a Function with this key
+        bool contains(const keyT& key) const {
+            return entries.count(key)>0;
+        }
+
+        /// true if the Function with this key is in memory
+        bool is_resident(const keyT& key) const {
+            auto it = entries.find(key);
+            return (it!=entries.end()) and it->second.f.is_initialized();
+        }
+
+        /// bytes of coefficients per process kept in memory
+        double resident_bytes() const {
+            double sum = 0.0;
+            for (const auto& e : entries) if (e.second.f.is_initialized()) sum += e.second.bytes;
+            return sum;
+        }
+
+        void set_budget(const double b) {
+            budget = b;
+            evict_to_budget(nullptr);
+        }
+
+        /// insert or replace the Function with this key; may evict others
+        void set(const keyT& key, const functionT& f) {
+            Entry& e = entries[key];
+            if (e.prefetched) {
+                e.prefetched->get();        // the slot is rewritten on the next eviction
+                e.prefetched.reset();
+            }
+            e.f = f;
+            e.bytes = f.is_initialized() ? double(f.size())*sizeof(T)/world.size() : 0.0;
+            e.dirty = true;
+            e.last_use = ++clock;
+            evict_to_budget(&key);
+        }
+
+        /// return the Function with this key, reading it from the scratch file if necessary; may evict others
+        functionT get(const keyT& key) {
+            auto it = entries.find(key);
+            if (it==entries.end()) MADNESS_EXCEPTION("FunctionStore: no Function with this key", 1);
+            Entry& e = it->second;
+            e.last_use = ++clock;
+            if (not e.f.is_initialized() and e.length>0) {
+                restore(e);
+                evict_to_budget(&key);
+            }
+            return e.f;
+        }
+
+        /// start reading the Function with this key in the background, if it is not in memory
+        void prefetch(const keyT& key) {
+            auto it = entries.find(key);
+            if (it==entries.end()) return;
+            Entry& e = it->second;
+            if (e.f.is_initialized() or e.prefetched or e.length==0) return;
+            e.prefetched = std::make_shared<Future<std::vector<unsigned char> > >(
+                    world.taskq.add(*this, &FunctionStore::read_blob, e.offset, e.length));
+        }
+
+        /// write the Function with this key to the scratch file and release it
+        void evict(const keyT& key) {
+            auto it = entries.find(key);
+            if (it!=entries.end()) evict(it->second);
+        }
+
+        /// remove the Function with this key; its slot in the scratch file is lost
+        void erase(const keyT& key) {
+            auto it = entries.find(key);
+            if (it==entries.end()) return;
+            if (it->second.prefetched) it->second.prefetched->get();
+            entries.erase(it);
+        }
+
+    private:
+
+        /// evict the least recently used Functions except \c keep until the budget is met
+        void evict_to_budget(const keyT* keep) {
+            double resident = resident_bytes();
+            while (resident>budget) {
+                Entry* lru = nullptr;
+                for (auto& kv : entries) {
+                    if (keep and not (kv.first<*keep) and not (*keep<kv.first)) continue;
+                    if (not kv.second.f.is_initialized()) continue;
+                    if (not lru or kv.second.last_use<lru->last_use) lru = &kv.second;
+                }
+                if (not lru) break;
+                resident -= lru->bytes;
+                evict(*lru);
+            }
+        }
+
+        void evict(Entry& e) {
+            if (not e.f.is_initialized()) return;
+            if (e.dirty) {
+                std::shared_ptr<FunctionImpl<T,NDIM> > impl = e.f.get_impl();
+                MADNESS_CHECK(impl->can_pack_nodes());
+                world.gop.fence();      // all updates of the coefficients must have completed
+
+                e.metadata.clear();
+                archive::VectorOutputArchive ar(e.metadata);
+                ar & long(impl->get_k());
+                impl->store_metadata(ar);
+
+                std::vector<unsigned char> blob(16, 0);
+                blob[0] = archive::record_raw;
+                impl->pack_local_nodes(blob);
+                std::vector<unsigned char> c = archive::compress_record(blob.data(), blob.size());
+                if (c.size()<blob.size()) blob.swap(c);
+                write_blob(e, blob);
+                e.dirty = false;
+            }
+            e.f = functionT();
+            e.bytes = 0.0;
+        }
+
+        /// read the Function back, from the prefetched blob if there is one
+        void restore(Entry& e) {
+            std::vector<unsigned char> blob;
+            if (e.prefetched) blob = e.prefetched->get();
+            else blob = read_blob(e.offset, e.length);
+            e.prefetched.reset();
+
+            archive::VectorInputArchive ar(e.metadata);
+            long k = 0;
+            ar & k;
+            e.f = FunctionFactory<T,NDIM>(world).k(k).empty();
+            e.f.get_impl()->load_metadata(ar);
+            auto slab = std::make_shared<std::vector<unsigned char> >(std::move(blob));
+            archive::decode_record(*slab);
+            e.f.get_impl()->unpack_nodes(slab, 16);
+            world.gop.fence();
+            e.bytes = double(e.f.size())*sizeof(T)/world.size();
+            e.dirty = false;
+        }
+
+        /// write into the slot of \c e, or into a new slot at the end of the file if it is too small
+        void write_blob(Entry& e, const std::vector<unsigned char>& blob) {
+            ScopedMutex<Mutex> lock(file_mutex);
+            if (blob.size()>e.capacity) {
+                e.offset = file_end;
+                e.capacity = blob.size();
+                file_end += blob.size();
+            }
+            e.length = blob.size();
+            file.seekp(e.offset);
+            file.write(reinterpret_cast<const char*>(blob.data()), blob.size());
+            file.flush();
+            if (not file) MADNESS_EXCEPTION(("FunctionStore: cannot write " + filename).c_str(), 1);
+        }
+
+        std::vector<unsigned char> read_blob(const std::uint64_t offset, const std::uint64_t length) const {
+            ScopedMutex<Mutex> lock(file_mutex);
+            std::vector<unsigned char> blob(length);
+            file.seekg(offset);
+            file.read(reinterpret_cast<char*>(blob.data()), length);
+            if (not file) MADNESS_EXCEPTION(("FunctionStore: cannot read " + filename).c_str(), 1);
+            return blob;
+        }
+    };
+
+}
+
+#endif // MADNESS_MRA_FUNCTIONSTORE_H__INCLUDED
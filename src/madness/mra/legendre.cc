@@ -35,6 +35,7 @@ using std::endl;
 
 #include <cmath>
 #include <madness/mra/legendre.h>
+#include <madness/mra/mratables.h>
 #include <madness/tensor/tensor.h>
 
 /// \file legendre.cc
@@ -91,7 +92,7 @@ namespace madness {
     }
 
     static bool data_is_read = false;
-    static const int max_npt = 64;
+    static const int max_npt = MRATables::max_npt;
 
     static const char *filename = "gaussleg";   // Is overridden by
     // These are the points and weights on [-1,1]
@@ -135,6 +136,21 @@ namespace madness {
         return true;
     }
 
+    /// Cache the quadrature points and weights of the binary tables (not collective)
+
+    /// The cached tensors are views of the mapped file.  Does nothing if the
+    /// quadrature is already loaded.
+    void load_quadrature(const MRATables& tables) {
+        if (data_is_read) return;
+        points[0] = Tensor<double>(0l);
+        weights[0] = Tensor<double>(0l);
+        for (int npt=1; npt<=max_npt; ++npt) {
+            points[npt] = tables.points(npt);
+            weights[npt] = tables.weights(npt);
+        }
+        data_is_read = true;
+    }
+
     /// Collective routine to pre-load and cache the quadrature points and weights
 
     /// Only process rank 0 will access the file.
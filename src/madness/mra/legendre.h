@@ -37,7 +37,10 @@
 #include <madness/world/MADworld.h>
 
 namespace madness {
+    class MRATables;
+
     extern void load_quadrature(World& world, const char* dir);
+    extern void load_quadrature(const MRATables& tables);
     extern void legendre_polynomials(double x, long order, double *p);
     extern void legendre_scaling_functions(double x, long k, double *p);
     extern void initialize_legendre_stuff();
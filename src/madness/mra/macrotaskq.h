@@ -17,7 +17,12 @@
  The user-defined macrotask is derived from MacroTaskIntermediate and must implement the run()
  method. A heterogeneous task queue is possible.
 
- TODO: priority q
+ Scheduling is decentralized: at the start of run_all the waiting tasks are distributed over
+ the subworlds by decreasing priority, balancing the estimated cost (longest processing time
+ first). Each subworld keeps its queue on its rank 0, runs its tasks by decreasing priority,
+ preferring tasks whose inputs are already in its cloud cache, and steals batches of tasks
+ from other subworlds once its own queue is empty.
+
  TODO: task submission from inside task (serialize task instead of replicate)
  TODO: update documentation
  TODO: consider serializing task member variables
@@ -29,8 +34,14 @@
 #ifndef SRC_MADNESS_MRA_MACROTASKQ_H_
 #define SRC_MADNESS_MRA_MACROTASKQ_H_
 
+#include <deque>
+#include <numeric>
+#include <queue>
+#include <set>
 #include <madness/world/cloud.h>
 #include <madness/world/world.h>
+#include <madness/world/worldcounters.h>
+#include <madness/world/worldtrace.h>
 #include <madness/mra/macrotaskpartitioner.h>
 
 namespace madness {
@@ -72,6 +83,12 @@ public:
 
     double get_priority() const {return priority;}
 
+    /// estimated cost of the task, used to balance the initial distribution over the subworlds
+    virtual double get_cost() const {return priority;}
+
+    /// number of input records of this task that are in the (process-local) cloud cache
+    virtual long ncached_inputs(const Cloud& cloud) const {return 0;}
+
     friend std::ostream& operator<<(std::ostream& os, const MacroTaskBase::Status s) {
     	if (s==MacroTaskBase::Status::Running) os << "Running";
     	if (s==MacroTaskBase::Status::Waiting) os << "Waiting";
@@ -107,6 +124,7 @@ class MacroTaskQ : public WorldObject< MacroTaskQ> {
     std::shared_ptr<World> subworld_ptr;
 	MacroTaskBase::taskqT taskq;
 	std::mutex taskq_mutex;
+	std::deque<long> local_queue;  ///< task numbers assigned to this process' subworld, by decreasing priority
 	long printlevel=0;
 	long nsubworld=1;
     std::shared_ptr< WorldDCPmapInterface< Key<1> > > pmap1;
@@ -154,11 +172,12 @@ public:
 	/// run all tasks, tasks may store the results in the cloud
 	void run_all(MacroTaskBase::taskqT vtask=MacroTaskBase::taskqT()) {
 
-		for (const auto& t : vtask) if (universe.rank()==0) t->set_waiting();
+		for (const auto& t : vtask) t->set_waiting();
 		for (int i=0; i<vtask.size(); ++i) add_replicated_task(vtask[i]);
 		if (printdebug()) print_taskq();
 
         universe.gop.fence();
+        distribute_waiting_tasks();
         universe.gop.set_forbid_fence(true); // make sure there are no hidden universe fences
         pmap1=FunctionDefaults<1>::get_pmap();
         pmap2=FunctionDefaults<2>::get_pmap();
@@ -180,16 +199,20 @@ public:
 			std::shared_ptr<MacroTaskBase> task=taskq[element];
             if (printdebug()) print("starting task no",element, "in subworld",subworld.id(),"at time",wall_time());
 
+			const double trace_start = tracing::Tracer::enabled() ? wall_time() : -1.0;
 			task->run(subworld,cloud, taskq);
+			if (trace_start >= 0.0)
+				tracing::Tracer::record_span(tracing::EventKind::macrotask, trace_start, wall_time(),
+						typeid(*task).name(), tracing::id_typename);
 
 			double cpu1=cpu_time();
-            set_complete(element);
 			tasktime+=(cpu1-cpu0);
 			if (subworld.rank()==0 and printlevel>=3) printf("completed task %3ld after %6.1fs at time %6.1fs\n",element,cpu1-cpu0,wall_time());
 
 		}
         universe.gop.set_forbid_fence(false);
 		universe.gop.fence();
+		for (auto& task : taskq) if (task->is_waiting() or task->is_running()) task->set_complete();
 		universe.gop.sum(tasktime);
         double cpu11=cpu_time();
         if (printlevel>=3) cloud.print_timings(universe);
@@ -215,11 +238,45 @@ public:
 
 	void add_tasks(MacroTaskBase::taskqT& vtask) {
         for (const auto& t : vtask) {
-            if (universe.rank()==0) t->set_waiting();
+            t->set_waiting();
             add_replicated_task(t);
         }
 	}
 
+	/// distribute tasks over nqueue queues by decreasing priority, balancing the cost
+
+	/// Greedy longest-processing-time-first assignment: the tasks are taken in the order
+	/// of decreasing priority (ties: decreasing cost) and each one is given to the queue
+	/// with the smallest total cost so far. Each queue lists its tasks by decreasing priority.
+	/// @param[in]  priority    priority of each task
+	/// @param[in]  cost        estimated cost of each task
+	/// @param[in]  nqueue      number of queues
+	/// @return     the task numbers for each queue
+	static std::vector<std::vector<long> > distribute(const std::vector<double>& priority,
+			const std::vector<double>& cost, const long nqueue) {
+		MADNESS_CHECK(priority.size()==cost.size() and nqueue>0);
+		std::vector<long> order(priority.size());
+		std::iota(order.begin(),order.end(),0l);
+		std::stable_sort(order.begin(),order.end(),[&](long a, long b) {
+			if (priority[a]!=priority[b]) return priority[a]>priority[b];
+			return cost[a]>cost[b];
+		});
+
+		// min-heap of (total cost, queue)
+		typedef std::pair<double,long> loadT;
+		std::priority_queue<loadT,std::vector<loadT>,std::greater<loadT> > load;
+		for (long q=0; q<nqueue; ++q) load.push({0.0,q});
+		std::vector<std::vector<long> > queues(nqueue);
+		for (long i : order) {
+			loadT least=load.top();
+			load.pop();
+			queues[least.second].push_back(i);
+			least.first+=std::max(cost[i],0.0);
+			load.push(least);
+		}
+		return queues;
+	}
+
     void print_taskq() const {
         universe.gop.fence();
         if (universe.rank()==0) {
@@ -235,40 +292,99 @@ private:
 		taskq.push_back(task);
 	}
 
-	/// scheduler is located on universe.rank==0
+	/// number of subworlds that actually hold processes, i.e. the number of queues
+	long nqueue() const {return std::min(nsubworld,long(universe.size()));}
+
+	/// fill the local queue of the subworld's rank 0 with its share of the waiting tasks
+
+	/// The taskq is replicated, so every process computes the same distribution without
+	/// communication; queue q is held by universe rank q, which is rank 0 of subworld q.
+	void distribute_waiting_tasks() {
+		std::vector<long> waiting;
+		std::set<const MacroTaskBase*> seen;     // a task may have been added more than once
+		for (std::size_t i=0; i<taskq.size(); ++i) {
+			if (taskq[i]->is_waiting() and seen.insert(taskq[i].get()).second) waiting.push_back(i);
+		}
+		std::vector<double> priority, cost;
+		for (long i : waiting) {
+			priority.push_back(taskq[i]->get_priority());
+			cost.push_back(taskq[i]->get_cost());
+		}
+		std::vector<std::vector<long> > queues=distribute(priority,cost,nqueue());
+
+		std::lock_guard<std::mutex> lock(taskq_mutex);
+		local_queue.clear();
+		if (universe.rank()<nqueue()) {
+			for (long i : queues[universe.rank()]) local_queue.push_back(waiting[i]);
+		}
+	}
+
+	/// number of the next task to be run by this subworld, -1 if all tasks are done
+
+	/// Decided by subworld rank 0 from its local queue or by stealing, then broadcast
+	/// within the subworld; no communication with other subworlds while the local queue
+	/// is not empty.
 	long get_scheduled_task_number(World& subworld) {
-		long number=0;
-		if (subworld.rank()==0) number=this->send(ProcessID(0), &MacroTaskQ::get_scheduled_task_number_local);
+		long number=-1;
+		if (subworld.rank()==0) {
+			number=pop_local_task();
+			if (number<0 and steal_tasks()) number=pop_local_task();
+		}
 		subworld.gop.broadcast_serializable(number, 0);
 		subworld.gop.fence();
+		if (number>=0) taskq[number]->set_running();
 		return number;
-
 	}
 
-	long get_scheduled_task_number_local() {
-		MADNESS_ASSERT(universe.rank()==0);
-		std::lock_guard<std::mutex> lock(taskq_mutex);
+	/// pop a task from the front of the local queue, preferring tasks with cached inputs
 
-		auto is_Waiting = [](const std::shared_ptr<MacroTaskBase>& mtb_ptr) {return mtb_ptr->is_waiting();};
-		auto it=std::find_if(taskq.begin(),taskq.end(),is_Waiting);
-		if (it!=taskq.end()) {
-			it->get()->set_running();
-			long element=it-taskq.begin();
-			return element;
+	/// Among the first few tasks (those of similar priority) the one with the most inputs
+	/// already in this process' cloud cache is chosen.
+	long pop_local_task() {
+		std::lock_guard<std::mutex> lock(taskq_mutex);
+		if (local_queue.empty()) return -1;
+		const std::size_t window=std::min(local_queue.size(),std::size_t(8));
+		std::size_t best=0;
+		long best_ncached=taskq[local_queue[0]]->ncached_inputs(cloud);
+		for (std::size_t i=1; i<window; ++i) {
+			const long ncached=taskq[local_queue[i]]->ncached_inputs(cloud);
+			if (ncached>best_ncached) {
+				best=i;
+				best_ncached=ncached;
+			}
 		}
-//		print("could not find task to schedule");
-		return -1;
+		const long number=local_queue[best];
+		local_queue.erase(local_queue.begin()+best);
+		return number;
 	}
 
-	/// scheduler is located on rank==0
-	void set_complete(const long task_number) const {
-		this->task(ProcessID(0), &MacroTaskQ::set_complete_local, task_number);
+	/// steal a batch of tasks from the other queues; return false if all queues are empty
+
+	/// The victims are visited round-robin, starting with the next subworld.
+	bool steal_tasks() {
+		static const Counter nrequest("macrotaskq.steal_requests");
+		static const Counter nstolen("macrotaskq.tasks_stolen");
+		const long n=nqueue();
+		for (long i=1; i<n; ++i) {
+			const ProcessID victim=(universe.rank()+i)%n;
+			nrequest += 1;
+			std::vector<long> batch=this->send(victim, &MacroTaskQ::steal_local);
+			if (batch.empty()) continue;
+			nstolen += batch.size();
+			std::lock_guard<std::mutex> lock(taskq_mutex);
+			for (long number : batch) local_queue.push_back(number);
+			return true;
+		}
+		return false;
 	}
 
-	/// scheduler is located on rank==0
-	void set_complete_local(const long task_number) const {
-		MADNESS_ASSERT(universe.rank()==0);
-		taskq[task_number]->set_complete();
+	/// give away half of the local queue, taken from its low-priority end
+	std::vector<long> steal_local() {
+		std::lock_guard<std::mutex> lock(taskq_mutex);
+		const std::size_t nsteal=(local_queue.size()+1)/2;
+		std::vector<long> batch(local_queue.end()-nsteal,local_queue.end());
+		local_queue.erase(local_queue.end()-nsteal,local_queue.end());
+		return batch;
 	}
 
 public:
@@ -394,6 +510,12 @@ private:
             print("this is task",typeid(task).name(),"with batch", task.batch,"priority",this->get_priority());
         }
 
+        long ncached_inputs(const Cloud& cloud) const override {
+            long n=0;
+            for (const auto& record : inputrecords.list) if (cloud.is_cached(record)) ++n;
+            return n;
+        }
+
         virtual void print_me_as_table(std::string s="") const {
             std::stringstream ss;
             std::string name=typeid(task).name();
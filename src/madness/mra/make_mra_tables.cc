@@ -0,0 +1,62 @@
+/*
+  This file is part of MADNESS.
+
+  Copyright (C) 2007,2010 Oak Ridge National Laboratory
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+
+  For more information please contact:
+
+  Robert J. Harrison
+  Oak Ridge National Laboratory
+  One Bethel Valley Road
+  P.O. Box 2008, MS-6367
+
+  email: harrisonrj@ornl.gov
+  tel:   865-241-3937
+  fax:   865-572-0680
+*/
+
+/// \file make_mra_tables.cc
+/// \brief Converts the text files coeffs, autocorr and gaussleg into mra_tables.bin
+
+/// Run by the build:
+/// \code
+///   make_mra_tables <directory of the text files> <output file>
+/// \endcode
+
+#include <madness/mra/mratables.h>
+#include <madness/mra/twoscale.h>
+#include <madness/mra/legendre.h>
+
+using namespace madness;
+
+int main(int argc, char** argv) {
+    World& world = initialize(argc, argv, true);
+    int status = 0;
+    if (argc != 3) {
+        if (world.rank() == 0) print("usage: make_mra_tables <data directory> <output file>");
+        status = 1;
+    }
+    else {
+        load_coeffs(world, argv[1]);
+        load_quadrature(world, argv[1]);
+        if (not test_two_scale_coefficients() or not gauss_legendre_test()) status = 1;
+        else if (world.rank() == 0) MRATables::write(argv[2]);
+    }
+    world.gop.fence();
+    finalize();
+    return status;
+}
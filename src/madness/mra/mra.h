@@ -2068,7 +2068,8 @@ namespace madness {
         // specialized version for 3D
         if (NDIM <= 3) {
             result.set_impl(f, false);
-            result.get_impl()->apply(op, *f.get_impl(), fence);
+            if (op.owner_computes()) result.get_impl()->apply_owner_computes(op, *f.get_impl(), fence);
+            else result.get_impl()->apply(op, *f.get_impl(), fence);
 
         } else {        // general version for higher dimension
             bool print_timings=true;
@@ -1135,8 +1135,11 @@ namespace madness {
 
         // values for eri: this must be done in full rank...
         if (veri.has_data()) {
-            tensorT val_ket2=val_ket.full_tensor_copy().emul(veri);
-            if (val_result.has_data()) val_ket2+=val_result.full_tensor_copy();
+            // ket*veri (+ result) in one pass, without copying full tensors
+            tensorT val_ket2;
+            if (val_result.has_data()) val_ket2=evaluate(expr(val_ket.reconstruct_tensor())*expr(veri)
+                    + expr(val_result.reconstruct_tensor()));
+            else val_ket2=evaluate(expr(val_ket.reconstruct_tensor())*expr(veri));
             // values2coeffs expensive (30%), coeffT() (relatively) cheap (8%)
             coeff_result=coeffT(values2coeffs(key,val_ket2),this->get_tensor_args());
 
@@ -3421,6 +3424,8 @@ namespace madness {
         truncate_on_project = true;
         apply_randomize = false;
         project_randomize = false;
+        defer_accumulation = false;
+        combine_accumulation = false;
         bc = BoundaryConditions<NDIM>(BC_FREE);
         tt = TT_FULL;
         cell = Tensor<double>(NDIM,2);
@@ -3453,6 +3458,8 @@ namespace madness {
     		std::cout << "             truncate_on_project" <<  ": " << truncate_on_project << std::endl;
     		std::cout << "                 apply_randomize" <<  ": " << apply_randomize << std::endl;
     		std::cout << "               project_randomize" <<  ": " << project_randomize << std::endl;
+    		std::cout << "              defer_accumulation" <<  ": " << defer_accumulation << std::endl;
+    		std::cout << "            combine_accumulation" <<  ": " << combine_accumulation << std::endl;
     		std::cout << "                              bc" <<  ": " << bc << std::endl;
     		std::cout << "                              tt" <<  ": " << tt << std::endl;
     		std::cout << "                            cell" <<  ": " << cell << std::endl;
@@ -3473,6 +3480,8 @@ namespace madness {
     template <std::size_t NDIM> bool FunctionDefaults<NDIM>::truncate_on_project;
     template <std::size_t NDIM> bool FunctionDefaults<NDIM>::apply_randomize;
     template <std::size_t NDIM> bool FunctionDefaults<NDIM>::project_randomize;
+    template <std::size_t NDIM> bool FunctionDefaults<NDIM>::defer_accumulation;
+    template <std::size_t NDIM> bool FunctionDefaults<NDIM>::combine_accumulation;
     template <std::size_t NDIM> BoundaryConditions<NDIM> FunctionDefaults<NDIM>::bc;
     template <std::size_t NDIM> TensorType FunctionDefaults<NDIM>::tt;
     template <std::size_t NDIM> Tensor<double> FunctionDefaults<NDIM>::cell;
@@ -3484,6 +3493,8 @@ namespace madness {
 
     template <std::size_t NDIM> std::vector< Key<NDIM> > Displacements<NDIM>::disp;
     template <std::size_t NDIM> std::vector< Key<NDIM> > Displacements<NDIM>::disp_periodicsum[64];
+    template <std::size_t NDIM> std::once_flag Displacements<NDIM>::disp_once;
+    template <std::size_t NDIM> std::once_flag Displacements<NDIM>::disp_periodicsum_once[64];
 
 }
 
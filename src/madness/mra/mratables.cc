@@ -0,0 +1,194 @@
+/*
+  This file is part of MADNESS.
+
+  Copyright (C) 2007,2010 Oak Ridge National Laboratory
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+
+  For more information please contact:
+
+  Robert J. Harrison
+  Oak Ridge National Laboratory
+  One Bethel Valley Road
+  P.O. Box 2008, MS-6367
+
+  email: harrisonrj@ornl.gov
+  tel:   865-241-3937
+  fax:   865-572-0680
+*/
+
+/// \file mratables.cc
+/// \brief Reading and writing the binary MRA tables
+
+#include <madness/mra/mratables.h>
+#include <madness/mra/twoscale.h>
+#include <madness/mra/legendre.h>
+#include <madness/world/worldhash.h>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace madness {
+
+    const char* MRATables::filename = "mra_tables.bin";
+
+    static const char magic[8] = {'M','A','D','T','A','B','L','E'};
+    static const std::uint32_t version = 1;
+
+    static std::size_t pad(std::size_t n) {
+        return (n + 15) & ~std::size_t(15);
+    }
+
+    /// checksum of the bytes after the header, whose size is a multiple of 16
+    static std::uint64_t checksum(const unsigned char* p, std::size_t n) {
+        return hashword(reinterpret_cast<const uint32_t*>(p), n/sizeof(uint32_t), 0u);
+    }
+
+    std::size_t MRATables::layout() {
+        std::size_t offset = pad(sizeof(Header));
+        twoscale_offset[0] = 0;
+        for (int k=1; k<=kmax; ++k) {
+            twoscale_offset[k] = offset;
+            offset = pad(offset + 4*k*k*sizeof(double));
+        }
+        autocorr_offset = offset;
+        offset = pad(offset + 4*kautoc*kautoc*kautoc*sizeof(double));
+        quadrature_offset[0] = 0;
+        for (int npt=1; npt<=max_npt; ++npt) {
+            quadrature_offset[npt] = offset;
+            offset = pad(offset + 2*npt*sizeof(double));
+        }
+        return offset;
+    }
+
+    MRATables::~MRATables() {
+        if (base) munmap(base, bytes);
+    }
+
+    std::shared_ptr<MRATables> MRATables::open(World& world, const std::string& dir) {
+        std::shared_ptr<MRATables> tables(new MRATables);
+        const std::size_t size = tables->layout();
+        const std::string path = dir + "/" + filename;
+
+        long ok = 0;
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        struct stat st;
+        if (fd >= 0 and fstat(fd, &st) == 0 and std::size_t(st.st_size) == size) {
+            // private and writable: tensors are views, and writing to one must not fail
+            void* p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+            if (p != MAP_FAILED) {
+                tables->base = static_cast<unsigned char*>(p);
+                tables->bytes = size;
+                Header h;
+                std::memcpy(&h, p, sizeof(h));
+                const std::size_t start = pad(sizeof(Header));
+                ok = std::memcmp(h.magic, magic, sizeof(magic)) == 0 and h.version == version
+                    and h.kmax == kmax and h.kautoc == kautoc and h.max_npt == max_npt and h.size == size
+                    and h.checksum == checksum(tables->base + start, size - start);
+            }
+        }
+        if (fd >= 0) close(fd);
+        world.gop.min(ok);
+        if (not ok) return nullptr;
+        return tables;
+    }
+
+    void MRATables::write(const std::string& path) {
+        MRATables tables;
+        const std::size_t size = tables.layout();
+        std::vector<unsigned char> v(size, 0);
+        auto put = [&v](std::size_t offset, const Tensor<double>& t) {
+            const Tensor<double> c = t.iscontiguous() ? t : copy(t);
+            std::memcpy(&v[offset], c.ptr(), c.size()*sizeof(double));
+        };
+
+        for (int k=1; k<=kmax; ++k) {
+            Tensor<double> h0, h1, g0, g1;
+            if (not two_scale_coefficients(k, &h0, &h1, &g0, &g1))
+                MADNESS_EXCEPTION("MRATables::write: twoscale coefficients not loaded", k);
+            const std::size_t kk = k*k*sizeof(double);
+            put(tables.twoscale_offset[k], h0);
+            put(tables.twoscale_offset[k] + kk, h1);
+            put(tables.twoscale_offset[k] + 2*kk, g0);
+            put(tables.twoscale_offset[k] + 3*kk, g1);
+        }
+
+        Tensor<double> c;
+        if (not autoc(kautoc, &c)) MADNESS_EXCEPTION("MRATables::write: autocorrelation coefficients not loaded", kautoc);
+        put(tables.autocorr_offset, c);
+
+        for (int npt=1; npt<=max_npt; ++npt) {
+            Tensor<double> x(npt), w(npt);
+            if (not gauss_legendre(npt, 0.0, 1.0, x.ptr(), w.ptr()))
+                MADNESS_EXCEPTION("MRATables::write: quadrature not loaded", npt);
+            put(tables.quadrature_offset[npt], x);
+            put(tables.quadrature_offset[npt] + npt*sizeof(double), w);
+        }
+
+        Header h;
+        std::memcpy(h.magic, magic, sizeof(magic));
+        h.version = version;
+        h.kmax = kmax;
+        h.kautoc = kautoc;
+        h.max_npt = max_npt;
+        h.size = size;
+        const std::size_t start = pad(sizeof(Header));
+        h.checksum = checksum(&v[start], size - start);
+        std::memcpy(&v[0], &h, sizeof(h));
+
+        FILE* file = fopen(path.c_str(), "wb");
+        if (not file or fwrite(v.data(), 1, size, file) != size or fclose(file) != 0)
+            MADNESS_EXCEPTION(("MRATables::write: cannot write " + path).c_str(), 1);
+    }
+
+    Tensor<double> MRATables::view(std::size_t offset, long ndim, const long* dims) const {
+        double* p = reinterpret_cast<double*>(base + offset);
+#ifndef TENSOR_USE_SHARED_ALIGNED_ARRAY
+        return Tensor<double>(ndim, dims, p, shared_from_this());
+#else
+        Tensor<double> t(ndim, dims, false);
+        std::memcpy(t.ptr(), p, t.size()*sizeof(double));
+        return t;
+#endif
+    }
+
+    Tensor<double> MRATables::twoscale(int k, int which) const {
+        MADNESS_ASSERT(k >= 1 and k <= kmax and which >= 0 and which < 4);
+        const long dims[2] = {k, k};
+        return view(twoscale_offset[k] + which*k*k*sizeof(double), 2, dims);
+    }
+
+    Tensor<double> MRATables::autocorr() const {
+        const long dims[3] = {kautoc, kautoc, 4*kautoc};
+        return view(autocorr_offset, 3, dims);
+    }
+
+    Tensor<double> MRATables::points(int npt) const {
+        MADNESS_ASSERT(npt >= 1 and npt <= max_npt);
+        const long dims[1] = {npt};
+        return view(quadrature_offset[npt], 1, dims);
+    }
+
+    Tensor<double> MRATables::weights(int npt) const {
+        MADNESS_ASSERT(npt >= 1 and npt <= max_npt);
+        const long dims[1] = {npt};
+        return view(quadrature_offset[npt] + npt*sizeof(double), 1, dims);
+    }
+
+}
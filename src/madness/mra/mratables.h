@@ -0,0 +1,121 @@
+/*
+  This file is part of MADNESS.
+
+  Copyright (C) 2007,2010 Oak Ridge National Laboratory
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+
+  For more information please contact:
+
+  Robert J. Harrison
+  Oak Ridge National Laboratory
+  One Bethel Valley Road
+  P.O. Box 2008, MS-6367
+
+  email: harrisonrj@ornl.gov
+  tel:   865-241-3937
+  fax:   865-572-0680
+*/
+
+#ifndef MADNESS_MRA_MRATABLES_H__INCLUDED
+#define MADNESS_MRA_MRATABLES_H__INCLUDED
+
+/// \file mratables.h
+/// \brief Binary, memory-mapped copy of the twoscale, autocorrelation and quadrature tables
+
+#include <madness/madness_config.h>
+#include <madness/tensor/tensor.h>
+#include <madness/world/MADworld.h>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace madness {
+
+    /// The tables read by load_coeffs and load_quadrature, in one binary file
+
+    /// Parsing the text files \c coeffs, \c autocorr and \c gaussleg is a
+    /// noticeable part of the start-up time of short jobs.  The build
+    /// converts them into \c mra_tables.bin (see make_mra_tables.cc), which
+    /// every process maps read-only: there is no parsing and no broadcast,
+    /// and the pages are shared by all processes of a node through the
+    /// page cache.  The tables handed out are views of the mapping.
+    ///
+    /// The file has a header followed by the tables as native doubles, each
+    /// at a multiple of 16 bytes: for k=1..kmax the twoscale matrices h0, h1,
+    /// g0, g1 (k*k each); the autocorrelation coefficients (kautoc, kautoc,
+    /// 4*kautoc) as returned by \c autoc(kautoc); for n=1..max_npt the
+    /// Gauss-Legendre points and weights on [0,1].
+    class MRATables : public std::enable_shared_from_this<MRATables> {
+    public:
+        static const int kmax = 60;         ///< largest order of the twoscale coefficients
+        static const int kautoc = 30;       ///< largest order of the autocorrelation coefficients
+        static const int max_npt = 64;      ///< largest number of tabulated quadrature points
+        static const char* filename;        ///< name of the file in the data directory
+
+    private:
+        struct Header {
+            char magic[8];
+            std::uint32_t version;
+            std::uint32_t kmax, kautoc, max_npt;
+            std::uint64_t size;             ///< of the whole file
+            std::uint64_t checksum;         ///< of everything after the header
+        };
+
+        unsigned char* base = nullptr;
+        std::size_t bytes = 0;
+        std::size_t twoscale_offset[kmax+1];
+        std::size_t autocorr_offset;
+        std::size_t quadrature_offset[max_npt+1];
+
+        MRATables() {}
+
+        MRATables(const MRATables&) = delete;
+        MRATables& operator=(const MRATables&) = delete;
+
+        /// offsets of the tables, the same for reading and writing
+        std::size_t layout();
+
+        Tensor<double> view(std::size_t offset, long ndim, const long* dims) const;
+
+    public:
+        ~MRATables();
+
+        /// Map the file in \c dir on all processes of \c world
+
+        /// Collective.  Returns null on all processes if one of them cannot
+        /// open the file or the file does not match this build, in which
+        /// case the text files must be used.
+        static std::shared_ptr<MRATables> open(World& world, const std::string& dir);
+
+        /// Write the tables as currently loaded (see load_coeffs and load_quadrature) to \c path
+        static void write(const std::string& path);
+
+        /// The twoscale matrices h0, h1, g0, g1 of order \c k
+        Tensor<double> twoscale(int k, int which) const;
+
+        /// The autocorrelation coefficients of order \c kautoc, see autoc
+        Tensor<double> autocorr() const;
+
+        /// Gauss-Legendre points on [0,1] of the \c npt point rule
+        Tensor<double> points(int npt) const;
+
+        /// Gauss-Legendre weights on [0,1] of the \c npt point rule
+        Tensor<double> weights(int npt) const;
+    };
+
+}
+
+#endif // MADNESS_MRA_MRATABLES_H__INCLUDED
@@ -177,6 +177,100 @@ namespace madness {
     ///
     /// I've not yet tested with anything except \c C=double and I think
     /// that the KAIN routine will need extending for anything else.
+    /// Where XNonlinearSolver keeps the subspace vectors of previous iterations
+    enum class SubspaceStorage {
+        memory,     ///< full copies in memory (default)
+        truncated,  ///< in memory, truncated at a looser threshold
+        disk        ///< written to per-process files, read back when needed
+    };
+
+    namespace detail {
+
+        /// true for the subspace vector types with truncated or disk storage
+        template <typename T>
+        struct is_function_subspace : std::false_type {};
+
+        template <typename T, std::size_t NDIM>
+        struct is_function_subspace<Function<T,NDIM> > : std::true_type {};
+
+        template <typename T, std::size_t NDIM>
+        struct is_function_subspace<std::vector<Function<T,NDIM> > > : std::true_type {};
+
+        template <typename T, std::size_t NDIM>
+        World* subspace_world(const Function<T,NDIM>& f) {
+            return f.is_initialized() ? &f.world() : nullptr;
+        }
+
+        template <typename T, std::size_t NDIM>
+        World* subspace_world(const std::vector<Function<T,NDIM> >& v) {
+            return (v.size()>0 and v[0].is_initialized()) ? &v[0].world() : nullptr;
+        }
+
+        /// replace f by a truncated copy (the caller may still hold f)
+        template <typename T, std::size_t NDIM>
+        void subspace_truncate(Function<T,NDIM>& f, double tol) {
+            f = copy(f);
+            f.truncate(tol);
+        }
+
+        /// replace v by a truncated copy (the caller may still hold v)
+        template <typename T, std::size_t NDIM>
+        void subspace_truncate(std::vector<Function<T,NDIM> >& v, double tol) {
+            if (v.size()==0) return;
+            v = copy(v[0].world(), v);
+            truncate(v[0].world(), v, tol);
+        }
+
+        /// Functions are stored with a parallel archive, vectors of them element by element
+        template <typename archiveT, typename T, std::size_t NDIM>
+        void subspace_store(const archiveT& ar, const Function<T,NDIM>& f) {
+            ar & f;
+        }
+
+        template <typename archiveT, typename T, std::size_t NDIM>
+        void subspace_store(const archiveT& ar, const std::vector<Function<T,NDIM> >& v) {
+            ar & v.size();
+            for (const auto& f : v) ar & f;
+        }
+
+        template <typename archiveT, typename T, std::size_t NDIM>
+        void subspace_load(const archiveT& ar, Function<T,NDIM>& f) {
+            ar & f;
+        }
+
+        template <typename archiveT, typename T, std::size_t NDIM>
+        void subspace_load(const archiveT& ar, std::vector<Function<T,NDIM> >& v) {
+            std::size_t n=0;
+            ar & n;
+            v.resize(n);
+            for (auto& f : v) ar & f;
+        }
+
+    }
+
+    /// Generalized version of NonlinearSolver not limited to a single madness function
+
+    /// \ingroup nonlinearsolve 
+    ///
+    /// This solves the equation \f$r(u) = 0\f$ where u and r are both
+    /// of type \c T and inner products between two items of type \c T
+    /// produce a number of type \c C (defaulting to double).  The type \c T
+    /// must support storage in an STL vector, scaling by a constant
+    /// of type \c C, inplace addition (+=), subtraction, allocation with
+    /// value zero, and inner products computed with the interface \c
+    /// inner(a,b).  Have a look in examples/testsolver.cc for a
+    /// simple but complete example, and in examples/h2dynamic.cc for a 
+    /// more complex example.
+    ///
+    /// I've not yet tested with anything except \c C=double and I think
+    /// that the KAIN routine will need extending for anything else.
+    ///
+    /// For \c T a Function or a vector of Functions the vectors of previous
+    /// iterations can be kept truncated at a looser threshold or on disk
+    /// instead of in memory (see set_subspace_storage), so that a larger
+    /// subspace does not multiply the memory footprint.  Each update makes
+    /// one pass over the stored vectors for the new row and column of the
+    /// subspace matrix and one for the new solution.
     template <class T, class C = double, class Alloc = default_allocator<T> >
     class XNonlinearSolver {
         unsigned int maxsub; ///< Maximum size of subspace dimension
@@ -184,6 +278,13 @@ namespace madness {
         std::vector<T> ulist, rlist; ///< Subspace information
         Tensor<C> Q;
         Tensor<C> c;		///< coefficients for linear combination
+
+        SubspaceStorage storage=SubspaceStorage::memory;
+        double storage_thresh=0.0;   ///< truncation threshold for SubspaceStorage::truncated
+        std::string storage_prefix;  ///< file name prefix for SubspaceStorage::disk
+        std::vector<std::string> files;   ///< file names of the stored pairs, empty if in memory
+        long nfile=0;                ///< number of files written so far, makes the names unique
+        int file_rank=0;             ///< rank of this process in the world the files were written in
     public:
         bool do_print;
 
@@ -196,19 +297,49 @@ namespace madness {
 	XNonlinearSolver(const XNonlinearSolver& other)
             : maxsub(other.maxsub)
             , alloc(other.alloc)
+            , storage(other.storage)
+            , storage_thresh(other.storage_thresh)
+            , storage_prefix(other.storage_prefix)
 			, do_print(other.do_print)
         {}
 
+	~XNonlinearSolver() {
+		remove_files();
+	}
 
+	/// the subspace vectors; only meaningful with SubspaceStorage::memory
 	std::vector<T>& get_ulist() {return ulist;}
 	std::vector<T>& get_rlist() {return rlist;}
 
 	void set_maxsub(int maxsub) {this->maxsub = maxsub;}
 	Tensor<C> get_c() const {return c;}
 
+	/// choose where the vectors of previous iterations are kept
+
+	/// Only the vectors of previous iterations are affected; the new
+	/// solution is always formed from them in full precision.  Takes
+	/// effect for vectors added from now on.
+	/// @param[in] s       the storage
+	/// @param[in] thresh  truncation threshold for SubspaceStorage::truncated
+	/// @param[in] prefix  file name prefix for SubspaceStorage::disk, must be unique among
+	///                    the solvers that exist at the same time (e.g. include a state index)
+	void set_subspace_storage(const SubspaceStorage s, const double thresh=0.0,
+			const std::string prefix="kain_subspace") {
+		if (s!=SubspaceStorage::memory and not detail::is_function_subspace<T>::value) {
+			MADNESS_EXCEPTION("subspace storage other than memory requires Functions or vectors of Functions",1);
+		}
+		storage=s;
+		storage_thresh=thresh;
+		storage_prefix=prefix;
+	}
+
+	SubspaceStorage get_subspace_storage() const {return storage;}
+
 	void clear_subspace() {
+		remove_files();
 		ulist.clear();
 		rlist.clear();
+		files.clear();
 		Q=Tensor<C>();
 	}
 
@@ -227,13 +358,16 @@ namespace madness {
 		int iter = ulist.size();
 		ulist.push_back(u);
 		rlist.push_back(r);
+		files.push_back("");
 
 		// Solve subspace equations
 		Tensor<C> Qnew(iter+1,iter+1);
 		if (iter>0) Qnew(Slice(0,-2),Slice(0,-2)) = Q;
 		for (int i=0; i<=iter; i++) {
-			Qnew(i,iter) = inner(ulist[i],rlist[iter]);
-			Qnew(iter,i) = inner(ulist[iter],rlist[i]);
+			with_pair(i, [&](const T& ui, const T& ri) {
+				Qnew(i,iter) = inner(ui,rlist[iter]);
+				Qnew(iter,i) = inner(ulist[iter],ri);
+			});
 		}
 		Q = Qnew;
 		c = KAIN(Q);
@@ -244,17 +378,75 @@ namespace madness {
 		// Form new solution in u
 		T unew = alloc();
 		for (int i=0; i<=iter; i++) {
-			unew += (ulist[i] - rlist[i])*c[i];
+			with_pair(i, [&](const T& ui, const T& ri) {
+				unew += (ui - ri)*c[i];
+			});
 		}
 
 		if (ulist.size() == maxsub) {
+			remove_file(0);
 			ulist.erase(ulist.begin());
 			rlist.erase(rlist.begin());
+			files.erase(files.begin());
 			Q = copy(Q(Slice(1,-1),Slice(1,-1)));
 		}
+		if (ulist.size()>0) store_pair(ulist.size()-1);
 		return unew;
 	}
 
+    private:
+
+	/// call op(u_i,r_i) for the i-th pair of the subspace, reading it from disk if necessary
+	template <typename opT>
+	void with_pair(const int i, opT op) const {
+		if (files[i].empty()) {
+			op(ulist[i],rlist[i]);
+			return;
+		}
+		if constexpr (detail::is_function_subspace<T>::value) {
+			T ui, ri;
+			World* world=detail::subspace_world(ulist.back());
+			archive::ParallelInputArchive<archive::BinaryFstreamInputArchive> ar(*world, files[i].c_str(), world->size());
+			detail::subspace_load(ar,ui);
+			detail::subspace_load(ar,ri);
+			op(ui,ri);
+		}
+	}
+
+	/// move the i-th pair to its final storage
+	void store_pair(const int i) {
+		if constexpr (detail::is_function_subspace<T>::value) {
+			World* world=detail::subspace_world(ulist[i]);
+			if (not world or not files[i].empty()) return;
+			if (storage==SubspaceStorage::truncated) {
+				detail::subspace_truncate(ulist[i],storage_thresh);
+				detail::subspace_truncate(rlist[i],storage_thresh);
+			} else if (storage==SubspaceStorage::disk) {
+				files[i]=storage_prefix+"."+std::to_string(nfile++);
+				file_rank=world->rank();
+				// one file per process (up to 50), which may be on a node-local disk
+				archive::ParallelOutputArchive<archive::BinaryFstreamOutputArchive> ar(*world, files[i].c_str(), world->size());
+				detail::subspace_store(ar,ulist[i]);
+				detail::subspace_store(ar,rlist[i]);
+				ulist[i]=T();
+				rlist[i]=T();
+			}
+		}
+	}
+
+	/// delete this process' file of the i-th pair, if any
+	void remove_file(const int i) {
+		if (files[i].empty()) return;
+		char buf[268];
+		snprintf(buf, sizeof(buf), "%s.%5.5d", files[i].c_str(), file_rank);
+		::remove(buf);
+		files[i].clear();
+	}
+
+	void remove_files() {
+		for (std::size_t i=0; i<files.size(); ++i) remove_file(i);
+	}
+
     };
 
 
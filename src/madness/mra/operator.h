@@ -76,6 +76,16 @@ namespace madness {
     };
 
 
+    /// The displacements of one level with their operator norms, sorted by decreasing norm
+
+    /// see SeparatedConvolution::get_screened_disp
+    template <std::size_t NDIM>
+    struct ScreenedDisplacements {
+        std::vector< Key<NDIM> > disp;
+        std::vector<double> norm;
+    };
+
+
     /// Convolutions in separated form (including Gaussian)
 
     /* this stuff is very confusing, poorly commented, and extremely poorly named!
@@ -121,6 +131,7 @@ namespace madness {
         bool modified_;     ///< use modified NS form
         int particle_;
         bool destructive_;	///< destroy the argument or restore it (expensive for 6d functions)
+        bool owner_computes_;	///< apply in NDIM<=3 by the owners of the result, see FunctionImpl::apply_owner_computes
 
         typedef Key<NDIM> keyT;
         const static size_t opdim=NDIM;
@@ -148,6 +159,7 @@ namespace madness {
         // SeparatedConvolutionData keeps data for all terms and all dimensions and 1 displacement
         mutable SimpleCache< SeparatedConvolutionData<Q,NDIM>, NDIM > data; ///< cache for all terms, dims and displacements
         mutable SimpleCache< SeparatedConvolutionData<Q,NDIM>, 2*NDIM > mod_data; ///< cache for all terms, dims and displacements
+        mutable SimpleCache< ScreenedDisplacements<NDIM>, 1 > screened_disp; ///< displacements sorted by norm, for each level
 
     public:
 
@@ -160,6 +172,9 @@ namespace madness {
         bool& destructive() {return destructive_;}
         const bool& destructive() const {return destructive_;}
 
+        bool& owner_computes() {return owner_computes_;}
+        const bool& owner_computes() const {return owner_computes_;}
+
         const double& gamma() const {return mu_;}
         const double& mu() const {return mu_;}
 
@@ -230,6 +245,7 @@ namespace madness {
 
             R* MADNESS_RESTRICT w1=work1.ptr();
             R* MADNESS_RESTRICT w2=work2.ptr();
+            std::uint64_t nflop=2*dimi*trans[0].r*dimk;
 
 #ifdef HAVE_IBMBGQ
             mTxmq_padding(dimi, trans[0].r, dimk, dimk, w1, f.ptr(), trans[0].U);
@@ -240,6 +256,7 @@ namespace madness {
             size = trans[0].r * size / dimk;
             dimi = size/dimk;
             for (std::size_t d=1; d<NDIM; ++d) {
+                nflop+=2*dimi*trans[d].r*dimk;
 #ifdef HAVE_IBMBGQ
                 mTxmq_padding(dimi, trans[d].r, dimk, dimk, w2, w1, trans[d].U);
 #else
@@ -258,6 +275,7 @@ namespace madness {
                 for (std::size_t d=0; d<NDIM; ++d) {
                     if (trans[d].VT) {
                         dimi = size/trans[d].r;
+                        nflop+=2*dimi*dimk*trans[d].r;
 #ifdef HAVE_IBMBGQ
                         mTxmq_padding(dimi, dimk, trans[d].r, dimk, w2, w1, trans[d].VT);
 #else
@@ -273,6 +291,8 @@ namespace madness {
             }
             // Assuming here that result is contiguous and aligned
             aligned_axpy(size, result.ptr(), w1, mufac);
+            static const Counter flops("operator.apply_transformation.flops");
+            flops += nflop+2*size;
         }
 
 
@@ -729,7 +749,8 @@ namespace madness {
         /// @return pointer to cached operator
         const SeparatedConvolutionData<Q,NDIM>* getop_ns(Level n, const Key<NDIM>& d) const {
             //PROFILE_MEMBER_FUNC(SeparatedConvolution); // Too fine grain for routine profiling
-            const SeparatedConvolutionData<Q,NDIM>* p = data.getptr(n,d);
+            static const CacheCounters counters("operator.ns_cache");
+            const SeparatedConvolutionData<Q,NDIM>* p = counters(data.getptr(n,d));
             if (p) return p;
 
             // get the data for each term
@@ -769,7 +790,8 @@ namespace madness {
             for (size_t i=0; i<NDIM; ++i) t[i]=t[i]%2;
             Key<2*NDIM> key=disp.merge_with(Key<NDIM>(source.level(),t));
 
-            const SeparatedConvolutionData<Q,NDIM>* p = mod_data.getptr(n,key);
+            static const CacheCounters counters("operator.mod_ns_cache");
+            const SeparatedConvolutionData<Q,NDIM>* p = counters(mod_data.getptr(n,key));
             if (p) return p;
 
             // get the data for each term
@@ -881,6 +903,7 @@ namespace madness {
                 , modified_(false)
                 , particle_(1)
                 , destructive_(false)
+                , owner_computes_(false)
                 , is_slaterf12(false)
                 , mu_(0.0)
                 , bc(bc)
@@ -916,6 +939,7 @@ namespace madness {
                 , modified_(false)
                 , particle_(1)
                 , destructive_(false)
+                , owner_computes_(false)
                 , is_slaterf12(false)
                 , mu_(0.0)
                 , ops(argops)
@@ -947,6 +971,7 @@ namespace madness {
                 , modified_(false)
                 , particle_(1)
                 , destructive_(false)
+                , owner_computes_(false)
                 , is_slaterf12(mu>0.0)
                 , mu_(mu)
                 , ops(coeff.dim(0))
@@ -992,6 +1017,7 @@ namespace madness {
                 , modified_(false)
                 , particle_(1)
                 , destructive_(false)
+                , owner_computes_(false)
                 , is_slaterf12(false)
                 , mu_(0.0)
                 , ops(coeff.dim(0))
@@ -1047,6 +1073,68 @@ namespace madness {
             return Displacements<NDIM>().get_disp(n, isperiodicsum);
         }
 
+        /// the displacements of level n with nonzero norm, sorted by decreasing operator norm
+
+        /// The norms are the ones of getop_ns, but they are computed from the
+        /// 1D blocks only, without making the operator for each displacement.
+        /// Given the norm of the source coefficients, the displacements that
+        /// pass the screening in FunctionImpl::do_apply are a prefix of this
+        /// table.  The table is made on first use.  NS form only.
+        const ScreenedDisplacements<NDIM>& get_screened_disp(Level n) const {
+            MADNESS_ASSERT(not modified());
+            static const CacheCounters counters("operator.screened_disp_cache");
+            const ScreenedDisplacements<NDIM>* p = counters(screened_disp.getptr(n,0));
+            if (p) return *p;
+
+            const std::vector< Key<NDIM> >& disp = get_disp(n);
+
+            // the 1D blocks of all terms and dimensions for all translations in disp
+            std::map<Translation,int> index;
+            for (const Key<NDIM>& d : disp) {
+                for (std::size_t i=0; i<NDIM; ++i) index.insert(std::make_pair(d.translation()[i],0));
+            }
+            const int ntrans=index.size();
+            int itrans=0;
+            for (auto& it : index) it.second=itrans++;
+            std::vector<const ConvolutionData1D<Q>*> ops1d(rank*NDIM*ntrans);
+            for (int mu=0; mu<rank; ++mu) {
+                for (std::size_t i=0; i<NDIM; ++i) {
+                    for (const auto& it : index) {
+                        ops1d[(mu*NDIM+i)*ntrans+it.second] = ops[mu].getop(i)->nonstandard(n, it.first);
+                    }
+                }
+            }
+
+            std::vector< std::pair<double,std::size_t> > table;
+            table.reserve(disp.size());
+            for (std::size_t idisp=0; idisp<disp.size(); ++idisp) {
+                int l[NDIM];
+                for (std::size_t i=0; i<NDIM; ++i) l[i] = index[disp[idisp].translation()[i]];
+                double norm = 0.0;
+                for (int mu=0; mu<rank; ++mu) {
+                    const ConvolutionData1D<Q>* op[NDIM];
+                    for (std::size_t i=0; i<NDIM; ++i) op[i] = ops1d[(mu*NDIM+i)*ntrans+l[i]];
+                    const double munorm = munorm2(n, op)*std::abs(ops[mu].getfac());
+                    norm += munorm*munorm;
+                }
+                if (norm > 0.0) table.push_back(std::make_pair(std::sqrt(norm),idisp));
+            }
+            // equal norms stay in order of increasing distance
+            std::stable_sort(table.begin(), table.end(),
+                    [](const std::pair<double,std::size_t>& a, const std::pair<double,std::size_t>& b) {
+                        return a.first > b.first;});
+
+            ScreenedDisplacements<NDIM> result;
+            result.disp.reserve(table.size());
+            result.norm.reserve(table.size());
+            for (const auto& t : table) {
+                result.disp.push_back(disp[t.second]);
+                result.norm.push_back(t.first);
+            }
+            screened_disp.set(n, 0, result);
+            return *screened_disp.getptr(n,0);
+        }
+
         /// return the operator norm for all terms, all dimensions and 1 displacement
         double norm(Level n, const Key<NDIM>& d, const Key<NDIM>& source_key) const {
             // SeparatedConvolutionData keeps data for all terms and all dimensions and 1 displacement
@@ -34,6 +34,7 @@
 #define MADNESS_MRA_SIMPLECACHE_H__INCLUDED
 
 #include <madness/mra/key.h>
+#include <madness/world/worldcounters.h>
 
 namespace madness {
     /// Simplified interface around hash_map to cache stuff for 1D
@@ -102,5 +103,24 @@ namespace madness {
             set(key, val);
         }
     };
+
+    /// Hit and miss counters of a cache lookup, see worldcounters.h
+
+    /// \code
+    ///    static const CacheCounters counters("mycache");
+    ///    const Q* p = counters(cache.getptr(key));
+    /// \endcode
+    struct CacheCounters {
+        Counter hit, miss;
+
+        explicit CacheCounters(const std::string& name) : hit(name+".hit"), miss(name+".miss") {}
+
+        /// Count the result of a lookup and pass the pointer through
+        template <typename Q>
+        const Q* operator()(const Q* p) const {
+            (p ? hit : miss) += 1;
+            return p;
+        }
+    };
 }
 #endif // MADNESS_MRA_SIMPLECACHE_H__INCLUDED
@@ -36,12 +36,18 @@
 /// \file mra/startup.cc
 
 #include <madness/mra/mra.h>
+#include <madness/mra/mratables.h>
 #include <madness/tensor/tensor.h>
 #include <madness/world/timers.h>
 //#include <madness/mra/mraimpl.h> !!!!!!!!!!!!!!!!  NOOOOOOOOOOOOOOOOOOOOOOOOOO !!!!!!!!!!!!!!!!!!!!!!!
 #include <iomanip>
 #include <cstdlib>
 
+// The build writes mra_tables.bin here, see make_mra_tables.cc
+#ifndef MRA_TABLES_DIR
+#define MRA_TABLES_DIR MRA_DATA_DIR
+#endif
+
 namespace madness {
 
 
@@ -82,7 +88,8 @@ namespace madness {
         }
 
         // Process environment variables
-        if (getenv("MRA_DATA_DIR")) data_dir = getenv("MRA_DATA_DIR");
+        const char* tables_dir = MRA_TABLES_DIR;
+        if (getenv("MRA_DATA_DIR")) data_dir = tables_dir = getenv("MRA_DATA_DIR");
 
         // Need to add an RC file ...
 
@@ -98,46 +105,53 @@ namespace madness {
 
 #ifdef FUNCTION_INSTANTIATE_1
         FunctionDefaults<1>::set_defaults(world);
-        Displacements<1> d1;
 #endif
 #ifdef FUNCTION_INSTANTIATE_2
         FunctionDefaults<2>::set_defaults(world);
-        Displacements<2> d2;
 #endif
 #ifdef FUNCTION_INSTANTIATE_3
         FunctionDefaults<3>::set_defaults(world);
-        Displacements<3> d3;
 #endif
 #ifdef FUNCTION_INSTANTIATE_4
         FunctionDefaults<4>::set_defaults(world);
-        Displacements<4> d4;
 #endif
 #ifdef FUNCTION_INSTANTIATE_5
         FunctionDefaults<5>::set_defaults(world);
-        Displacements<5> d5;
 #endif
 #ifdef FUNCTION_INSTANTIATE_6
         FunctionDefaults<6>::set_defaults(world);
-        Displacements<6> d6;
 #endif
 
-        //if (world.rank() == 0) print("loading coeffs, etc.");
+        // Displacements<NDIM> are made on first use
+
+        // Map the binary tables made by the build; otherwise parse the text files
+        std::shared_ptr<MRATables> tables = MRATables::open(world, tables_dir);
+        if (tables) {
+            load_coeffs(*tables);
+            load_quadrature(*tables);
+        }
+        else {
+            //if (world.rank() == 0) print("loading coeffs, etc.");
 
-        load_coeffs(world, data_dir);
+            load_coeffs(world, data_dir);
 
-        //if (world.rank() == 0) print("loading quadrature, etc.");
+            //if (world.rank() == 0) print("loading quadrature, etc.");
 
-        load_quadrature(world, data_dir);
+            load_quadrature(world, data_dir);
+        }
 
         // This to init static data while single threaded
         initialize_legendre_stuff();
 
-        //if (world.rank() == 0) print("testing coeffs, etc.");
-        MADNESS_CHECK(gauss_legendre_test());
-        MADNESS_CHECK(test_two_scale_coefficients());
+        // The binary tables are checksummed
+        if (not tables) {
+            //if (world.rank() == 0) print("testing coeffs, etc.");
+            MADNESS_CHECK(gauss_legendre_test());
+            MADNESS_CHECK(test_two_scale_coefficients());
+        }
 
-	int mflopslo, mflopshi;
-	time_transform(world, mflopslo, mflopshi);
+	int mflopslo = 0, mflopshi = 0;
+	if (doprint) time_transform(world, mflopslo, mflopshi);
 
         // print the configuration options
         if (doprint && world.rank() == 0) {
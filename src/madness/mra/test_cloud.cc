@@ -102,13 +102,103 @@ void simple_example(World &universe) {
     }   // subworld is destroyed here
 }
 
+/// store compressed records and load them through the per-node replicas
+
+/// Blocks of two ranks are treated as one node, so that with more than two
+/// processes some subworlds load records owned by another node.
+int test_replicated_compressed(World &universe) {
+    test_output t1("testing record compression");
+    Tensor<double> c(5, 6, 7);
+    c.fillrandom();
+    c(Slice(0, 2), _, _) = 0.0;
+    std::vector<unsigned char> raw((unsigned char *) c.ptr(), (unsigned char *) (c.ptr() + c.size()));
+    raw.push_back(7);   // trailing byte that does not fill a word
+    auto packed = archive::compress_record(raw.data(), raw.size());
+    auto unpacked = archive::decompress_record(packed);
+    t1.logger << "raw size " << raw.size() << " compressed size " << packed.size() << std::endl;
+    int success = t1.end(unpacked == raw and packed.size() < raw.size());
+
+    test_output t2("testing replicated and compressed cloud");
+    setenv("MAD_CLOUD_NODE_SIZE", "2", 1);
+    {
+        Cloud cloud(universe);
+        unsetenv("MAD_CLOUD_NODE_SIZE");
+        cloud.set_replicate(true);
+        cloud.set_compress(true);
+
+        real_function_3d f = real_factory_3d(universe).functor(gaussian(1.0));
+        const double fnorm = f.norm2();
+        const double cnorm = c.normf();
+        auto frecords = cloud.store(universe, f);
+        auto crecords = cloud.store(universe, c);
+
+        auto subworld_ptr = MacroTaskQ::create_worlds(universe, universe.size());
+        World &subworld = *subworld_ptr;
+        double error = 0.0;
+        {
+            MacroTaskQ::set_pmap(subworld);
+            for (int i = 0; i < 2; ++i) {
+                auto fsub = cloud.load<real_function_3d>(subworld, frecords);
+                auto csub = cloud.load<Tensor<double>>(subworld, crecords);
+                error = std::max({error, std::abs(fsub.norm2() - fnorm), std::abs(csub.normf() - cnorm)});
+                cloud.clear_cache(subworld);
+            }
+            MacroTaskQ::set_pmap(universe);
+        }
+        subworld.gop.fence();
+        universe.gop.fence();
+        universe.gop.max(error);
+        cloud.print_timings(universe);
+        t2.logger << "error " << error << std::endl;
+        success += t2.end(error < 1.e-12);
+    }
+    universe.gop.fence();
+    return success;
+}
+
+/// store Functions in reconstructed and compressed form and check that their trees are restored
+int test_function_slabs(World &universe) {
+    test_output t1("testing cloud/Function slabs");
+    real_function_3d f = real_factory_3d(universe).functor(gaussian(1.0));
+    real_function_3d g = real_factory_3d(universe).functor(gaussian(2.0));
+    g.compress();
+    std::vector<real_function_3d> vf{f, g};
+    const double fnorm = f.norm2(), gnorm = g.norm2();
+    const std::size_t fsize = f.tree_size(), gsize = g.tree_size();
+
+    Cloud cloud(universe);
+    auto records = cloud.store(universe, vf);
+
+    // subworlds with more than one process insert nodes owned by other processes
+    auto subworld_ptr = MacroTaskQ::create_worlds(universe, std::max(1, universe.size() / 2));
+    World &subworld = *subworld_ptr;
+    bool ok = true;
+    {
+        MacroTaskQ::set_pmap(subworld);
+        auto vsub = cloud.load<std::vector<real_function_3d>>(subworld, records);
+        ok = ok and vsub[0].is_reconstructed() and vsub[1].is_compressed();
+        ok = ok and vsub[0].tree_size() == fsize and vsub[1].tree_size() == gsize;
+        const double error = std::max(std::abs(vsub[0].norm2() - fnorm), std::abs(vsub[1].norm2() - gnorm));
+        t1.logger << "error " << error << std::endl;
+        ok = ok and error < 1.e-12;
+        MacroTaskQ::set_pmap(universe);
+        cloud.clear_cache(subworld);
+    }
+    subworld.gop.fence();
+    universe.gop.fence();
+    int nfail = ok ? 0 : 1;
+    universe.gop.sum(nfail);
+    return t1.end(nfail == 0);
+}
+
 int main(int argc, char **argv) {
 
     madness::World &universe = madness::initialize(argc, argv);
     startup(universe, argc, argv);
 
     simple_example(universe);
-    int success = 0;
+    int success = test_replicated_compressed(universe);
+    success += test_function_slabs(universe);
     {
         Cloud cloud(universe);
 //        cloud.set_debug(true);
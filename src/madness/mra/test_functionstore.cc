@@ -0,0 +1,72 @@
+/*
+ * test_functionstore.cc
+ *
+ * tests eviction, restoring and prefetching of the FunctionStore
+ */
+
+#include<madness/mra/mra.h>
+#include<madness/mra/functionstore.h>
+#include<madness/world/test_utilities.h>
+
+using namespace madness;
+
+struct gaussian {
+    double a;
+    gaussian(double a) : a(a) {}
+    double operator()(const coord_3d& r) const {
+        return exp(-a*(r[0]*r[0] + r[1]*r[1] + r[2]*r[2]));
+    }
+};
+
+typedef std::pair<int,int> keyT;
+
+int test_store(World& world) {
+    test_output t("store and evict");
+    bool success = true;
+
+    std::vector<real_function_3d> ref(5);
+    for (int i=0; i<5; ++i) ref[i] = real_factory_3d(world).functor(gaussian(1.0+i));
+    const double bytes = double(ref[0].size())*sizeof(double)/world.size();
+
+    // room for about two functions
+    FunctionStore<keyT,double,3> store(world, "test_functionstore", 2.5*bytes);
+    for (int i=0; i<5; ++i) store.set(keyT(i,i), copy(ref[i]));
+    t.logger << "resident bytes " << store.resident_bytes() << " budget " << 2.5*bytes << std::endl;
+    success = success and store.resident_bytes() <= 2.5*bytes;
+    success = success and not store.is_resident(keyT(0,0));
+    success = success and store.is_resident(keyT(4,4));
+
+    // read back all, with and without prefetching
+    store.prefetch(keyT(1,1));
+    for (int i=0; i<5; ++i) {
+        real_function_3d f = store.get(keyT(i,i));
+        const double error = (f - ref[i]).norm2();
+        t.logger << "error " << i << " " << error << std::endl;
+        success = success and error < 1.e-14;
+    }
+
+    // replace a function that is on disk
+    store.evict(keyT(2,2));
+    store.set(keyT(2,2), 2.0*ref[2]);
+    store.evict(keyT(2,2));
+    const double error = (store.get(keyT(2,2)) - 2.0*ref[2]).norm2();
+    t.logger << "error after replace " << error << std::endl;
+    success = success and error < 1.e-14;
+    return t.end(success);
+}
+
+int main(int argc, char** argv) {
+    World& world = initialize(argc, argv);
+    startup(world, argc, argv);
+    FunctionDefaults<3>::set_k(6);
+    FunctionDefaults<3>::set_thresh(1.e-5);
+    FunctionDefaults<3>::set_cubic_cell(-10.0, 10.0);
+
+    int result = 0;
+    result += test_store(world);
+
+    world.gop.sum(result);
+    if (world.rank()==0) print("result", result);
+    finalize();
+    return result;
+}
@@ -0,0 +1,88 @@
+/*
+ * test_kain.cc
+ *
+ * tests the subspace storage options of XNonlinearSolver
+ */
+
+#include<madness/mra/mra.h>
+#include<madness/mra/nonlinsol.h>
+#include<madness/world/test_utilities.h>
+#include<fstream>
+
+using namespace madness;
+
+static double gauss(const coord_3d& r) {
+    return exp(-(r[0]*r[0] + r[1]*r[1] + r[2]*r[2]));
+}
+
+static double source(const coord_3d& r) {
+    return exp(-2.0*((r[0]-0.5)*(r[0]-0.5) + r[1]*r[1] + r[2]*r[2]));
+}
+
+/// the solver needs zero functions to accumulate the new solution
+struct vector_allocator {
+    World& world;
+    const int n;
+    vector_allocator(World& world, const int n) : world(world), n(n) {}
+    std::vector<real_function_3d> operator()() {
+        return zero_functions<double,3>(world, n);
+    }
+};
+
+/// solve u = f + 0.5 h u for two right-hand sides f, return the solution and the number of iterations
+std::vector<real_function_3d> solve(World& world, const SubspaceStorage storage,
+        const std::string prefix, int& niter) {
+    real_function_3d h = real_factory_3d(world).f(gauss);
+    std::vector<real_function_3d> f(2);
+    f[0] = real_factory_3d(world).f(source);
+    f[1] = 2.0*h;
+
+    XNonlinearSolver<std::vector<real_function_3d>,double,vector_allocator>
+        solver(vector_allocator(world,2));
+    solver.set_maxsub(4);
+    solver.set_subspace_storage(storage, 1.e-3, prefix);
+
+    std::vector<real_function_3d> u = copy(world, f);
+    for (niter=0; niter<20; ++niter) {
+        std::vector<real_function_3d> r = u - f - 0.5*h*u;
+        truncate(world, r);
+        if (norm2(world, r)<1.e-5) break;
+        u = solver.update(u, r);
+        truncate(world, u);
+    }
+    return u;
+}
+
+int test_storage(World& world, const SubspaceStorage storage, const std::string name) {
+    test_output t("subspace storage " + name);
+    int niter_ref, niter;
+    std::vector<real_function_3d> uref = solve(world, SubspaceStorage::memory, "", niter_ref);
+    std::vector<real_function_3d> u = solve(world, storage, "test_kain_" + name, niter);
+    double error = norm2(world, sub(world, u, uref));
+    t.logger << "iterations " << niter_ref << " " << niter << " error " << error << std::endl;
+    bool success = (niter<20) and (error<1.e-4);
+
+    // all files must have been removed with the solver
+    world.gop.fence();
+    std::ifstream file(("test_kain_" + name + ".0.00000").c_str());
+    success = success and not file.good();
+    return t.end(success);
+}
+
+int main(int argc, char** argv) {
+    World& world = initialize(argc, argv);
+    startup(world, argc, argv);
+    FunctionDefaults<3>::set_k(6);
+    FunctionDefaults<3>::set_thresh(1.e-5);
+    FunctionDefaults<3>::set_cubic_cell(-10.0, 10.0);
+
+    int result = 0;
+    result += test_storage(world, SubspaceStorage::memory, "memory");
+    result += test_storage(world, SubspaceStorage::truncated, "truncated");
+    result += test_storage(world, SubspaceStorage::disk, "disk");
+
+    world.gop.sum(result);
+    if (world.rank()==0) print("result", result);
+    finalize();
+    return result;
+}
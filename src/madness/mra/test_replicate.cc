@@ -0,0 +1,91 @@
+/*
+ * test_replicate.cc
+ *
+ * tests replicating Functions in node-shared memory, see world_topology.h
+ */
+
+#include<madness/mra/mra.h>
+#include<madness/world/world_topology.h>
+#include<madness/world/test_utilities.h>
+#include<cstdlib>
+
+using namespace madness;
+
+static double gauss(const coord_3d& r) {
+    return exp(-(r[0]*r[0] + 2.0*r[1]*r[1] + 3.0*r[2]*r[2]));
+}
+
+/// number of nodes of f on this process that differ from the nodes of the distributed g
+long ndifferent(const real_function_3d& f, const real_function_3d& g) {
+    long n = 0;
+    const auto& fc = f.get_impl()->get_coeffs();
+    const auto& gc = g.get_impl()->get_coeffs();
+    for (auto it = fc.begin(); it != fc.end(); ++it) {
+        auto git = gc.find(it->first).get();
+        if (git == gc.end()) {
+            ++n;
+            continue;
+        }
+        const auto& a = it->second.coeff();
+        const auto& b = git->second.coeff();
+        if (a.has_data() != b.has_data()) ++n;
+        else if (a.has_data() and (a.full_tensor() - b.full_tensor()).normf() > 1.e-14) ++n;
+    }
+    return n;
+}
+
+int test_replicate(World& world) {
+    test_output t("replicate in node-shared memory");
+    bool success = world.node_topology() != nullptr;
+
+    real_function_3d g = real_factory_3d(world).f(gauss);
+    real_function_3d f = copy(g);
+    auto map = f.get_pmap();
+    const long nnode = g.tree_size();
+
+    f.replicate();
+    long nlocal = f.get_impl()->get_coeffs().size();
+    long ndiff = ndifferent(f, g);
+    world.gop.fence();
+    t.logger << "nodes " << nnode << " local " << nlocal << " different " << ndiff << std::endl;
+    success = success and nlocal == nnode and ndiff == 0;
+
+    // the copies are private
+    if (world.rank() == 0) {
+        auto& fc = f.get_impl()->get_coeffs();
+        for (auto it = fc.begin(); it != fc.end(); ++it) {
+            if (it->second.has_coeff()) it->second.coeff().scale(2.0);
+        }
+    }
+    world.gop.fence();
+    ndiff = ndifferent(f, g);
+    t.logger << "different after changing the nodes of rank 0 " << ndiff << std::endl;
+    success = success and ((world.rank() == 0) ? ndiff > 0 : ndiff == 0);
+
+    // back to the original distribution
+    f = copy(g);
+    f.replicate();
+    f.distribute(map);
+    const double error = (f - g).norm2();
+    t.logger << "error after distribution " << error << std::endl;
+    success = success and error < 1.e-14 and f.tree_size() == nnode;
+    return t.end(success);
+}
+
+int main(int argc, char** argv) {
+    setenv("MAD_NODE_TOPOLOGY", "1", 1);
+    setenv("MAD_NODE_SIZE", "2", 1);
+    World& world = initialize(argc, argv);
+    startup(world, argc, argv);
+    FunctionDefaults<3>::set_k(6);
+    FunctionDefaults<3>::set_thresh(1.e-5);
+    FunctionDefaults<3>::set_cubic_cell(-10.0, 10.0);
+
+    int result = 0;
+    result += test_replicate(world);
+
+    world.gop.sum(result);
+    if (world.rank()==0) print("result", result);
+    finalize();
+    return result;
+}
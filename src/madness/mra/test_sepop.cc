@@ -3680,4 +3680,63 @@ namespace madness {
         //cout << "MAXERR " << maxerr << endl;
         return (maxerr < 2e-13);
     }
+
+    /// benchmark eager vs deferred accumulation of low rank addends into a 6D node
+
+    /// Mimics a destination node of a 6D apply that receives many low rank results:
+    /// the eager mode adds each addend with add_SVD (FunctionNode::accumulate), the
+    /// deferred mode collects them and recompresses once (accumulate_deferred and
+    /// consolidate_buffer). Prints time and final rank of both; returns false if
+    /// either sum is off by more than the threshold.
+    bool test_deferred_accumulation(World& world) {
+        typedef FunctionNode<double,6> nodeT;
+        typedef nodeT::coeffT coeffT;
+        const long k=6, n=k*k*k;        // particle-wise matrix dimension of a 6D node
+        const long naddend=48, rank=6, nbasis=30;
+        const double thresh=1.e-6;
+        const TensorArgs targs(thresh,TT_2D);
+
+        // the addends share a common basis, so their sum has low rank as well
+        Tensor<double> u(nbasis,n), v(nbasis,n);
+        u.fillrandom();
+        v.fillrandom();
+        std::vector<coeffT> addends;
+        Tensor<double> exact(n,n);
+        for (long i=0; i<naddend; ++i) {
+            Tensor<double> cu(rank,nbasis), cv(rank,nbasis);
+            cu.fillrandom();
+            cv.fillrandom();
+            Tensor<double> a=inner(inner(cu,u),inner(cv,v),0,0);
+            a.scale(1.0/a.normf());
+            exact+=a;
+            addends.push_back(coeffT(a.reshape(k,k,k,k,k,k),targs));
+        }
+        exact=exact.reshape(k,k,k,k,k,k);
+
+        nodeT::dcT dc(world);
+        const Key<6> key(0);
+
+        nodeT eager;
+        double wall0=wall_time();
+        for (const coeffT& a : addends) eager.accumulate(a,dc,key,targs);
+        eager.consolidate_buffer(targs);
+        const double time_eager=wall_time()-wall0;
+
+        nodeT deferred;
+        wall0=wall_time();
+        for (const coeffT& a : addends) deferred.accumulate_deferred(a,dc,key);
+        deferred.consolidate_buffer(targs);
+        const double time_deferred=wall_time()-wall0;
+
+        const double err_eager=(eager.coeff().full_tensor_copy()-exact).normf();
+        const double err_deferred=(deferred.coeff().full_tensor_copy()-exact).normf();
+        if (world.rank()==0) {
+            print("accumulation of",naddend,"addends in 6D, thresh",thresh);
+            printf("   eager    time %8.4fs  rank %4ld  error %10.2e\n",time_eager,eager.coeff().rank(),err_eager);
+            printf("   deferred time %8.4fs  rank %4ld  error %10.2e\n",time_deferred,deferred.coeff().rank(),err_deferred);
+        }
+        world.gop.fence();
+        const double tol=thresh*exact.normf();
+        return (err_eager<tol) and (err_deferred<tol);
+    }
 }
@@ -231,6 +231,32 @@ int test_2d_partitioning(World& universe, const std::vector<real_function_3d>& v
     return success;
 }
 
+int test_distribution(World& universe) {
+    if (universe.rank() == 0) print("\nstarting distribution of tasks over subworlds");
+    // 2 expensive tasks and 6 cheap ones with priority proportional to the cost
+    std::vector<double> cost={8,1,1,8,1,1,1,1};
+    std::vector<std::vector<long> > queues=MacroTaskQ::distribute(cost,cost,3);
+    std::vector<double> load(queues.size(),0.0);
+    std::vector<long> count(cost.size(),0);
+    bool sorted=true;
+    for (std::size_t q=0; q<queues.size(); ++q) {
+        for (std::size_t i=0; i<queues[q].size(); ++i) {
+            load[q]+=cost[queues[q][i]];
+            count[queues[q][i]]++;
+            if (i>0 and cost[queues[q][i]]>cost[queues[q][i-1]]) sorted=false;
+        }
+    }
+    bool complete=std::all_of(count.begin(),count.end(),[](long c){return c==1;});
+    bool balanced=(*std::max_element(load.begin(),load.end())==8.0);
+    bool success=complete and sorted and balanced;
+    if (universe.rank() == 0) {
+        print("loads of the queues", load);
+        if (success) print("test distribution  \033[32m", "passed ", "\033[0m");
+        else print("test distribution  \033[31m", "failed \033[0m ");
+    }
+    return (success) ? 0 : 1;
+}
+
 int main(int argc, char **argv) {
     madness::World &universe = madness::initialize(argc, argv);
     startup(universe, argc, argv);
@@ -273,6 +299,8 @@ int main(int argc, char **argv) {
         success+=test_2d_partitioning(universe,v3);
         timer1.tag("2D partitioning");
 
+        success+=test_distribution(universe);
+
         if (universe.rank() == 0) {
             if (success==0) print("\n --> all tests \033[32m", "passed ", "\033[0m\n");
             else print("\n --> all tests \033[31m", "failed \033[0m \n");
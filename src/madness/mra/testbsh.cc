@@ -175,6 +175,122 @@ int test_bsh(World& world) {
     return success;
 }
 
+/// compare apply with and without combining of the accumulation into hot destination nodes
+
+/// Reports the time and the number of lock waits on the destination nodes of both
+/// variants; the results must agree up to the order of summation.
+template <typename T>
+int test_combine_accumulation(World& world) {
+    typedef Vector<double,3> coordT;
+    typedef std::shared_ptr< FunctionFunctorInterface<T,3> > functorT;
+
+    if (world.rank() == 0)
+        print("\nTest combining accumulation in apply, type =", archive::get_type_name<T>());
+
+    // a steep function: most results of the apply go to the few boxes around the origin
+    FunctionDefaults<3>::set_cubic_cell(-20,20);
+    FunctionDefaults<3>::set_k(8);
+    FunctionDefaults<3>::set_initial_level(5);
+    const double expnt = 1.e3;
+    const double coeff = pow(expnt/constants::pi,1.5);
+    Function<T,3> f = FunctionFactory<T,3>(world).functor(functorT(new Gaussian<T,3>(coordT(0.0), expnt, coeff)));
+    f.truncate();
+    const T trace = f.trace();
+    const std::size_t size = f.size();
+    if (world.rank() == 0) print("   norm and size of the input function", trace, size);
+    SeparatedConvolution<T,3> op = BSHOperator<3>(world, 1.0, 1e-4, 1e-8);
+
+    const std::string waits="hashmap.entry_lock_waits";
+    std::vector<Function<T,3> > result(2);
+    for (int combine=0; combine<2; ++combine) {
+        FunctionDefaults<3>::set_combine_accumulation(combine);
+        world.gop.fence();
+        CounterRegistry::reset();
+        double start = wall_time();
+        result[combine] = op(f);
+        double time = wall_time() - start;
+        std::uint64_t nwait = CounterRegistry::sum(world)[waits];
+        if (world.rank() == 0) print(combine ? "   combined" : "      eager", "time", time, "lock waits", nwait);
+    }
+    FunctionDefaults<3>::set_combine_accumulation(false);
+
+    double diff = (result[0] - result[1]).norm2();
+    if (world.rank() == 0) print("   difference of the results", diff);
+    world.gop.fence();
+    return (diff < 1.e-10*result[0].norm2()) ? 0 : 1;
+}
+
+/// the table of screened displacements has the norms of the operator, in decreasing order
+template <typename T>
+int test_screened_displacements(World& world) {
+    if (world.rank() == 0)
+        print("\nTest the table of screened displacements, type =", archive::get_type_name<T>());
+
+    FunctionDefaults<3>::set_cubic_cell(-20,20);
+    FunctionDefaults<3>::set_k(8);
+    SeparatedConvolution<T,3> op = BSHOperator<3>(world, 1.0, 1e-4, 1e-6);
+
+    int nerror = 0;
+    for (Level n : {0, 2, 5}) {
+        const ScreenedDisplacements<3>& table = op.get_screened_disp(n);
+        std::size_t nnonzero = 0;
+        for (const Key<3>& d : op.get_disp(n)) if (op.norm(n,d,d) > 0.0) ++nnonzero;
+        if (table.disp.size() != nnonzero) ++nerror;
+
+        double maxerr = 0.0;
+        for (std::size_t i=0; i<table.disp.size(); ++i) {
+            const double norm = op.norm(n,table.disp[i],table.disp[i]);
+            maxerr = std::max(maxerr, std::abs(norm-table.norm[i])/norm);
+            if (i>0 and table.norm[i]>table.norm[i-1]) ++nerror;
+        }
+        if (maxerr > 1.e-14) ++nerror;
+        if (world.rank() == 0) print("   level", n, "displacements", table.disp.size(), "relative error of the norms", maxerr);
+    }
+    return (nerror == 0) ? 0 : 1;
+}
+
+/// compare apply with the results sent to their owners and computed by their owners
+
+/// Reports the time and the bytes sent by both variants; the results must
+/// agree up to the order of summation.
+template <typename T>
+int test_owner_computes(World& world) {
+    typedef Vector<double,3> coordT;
+    typedef std::shared_ptr< FunctionFunctorInterface<T,3> > functorT;
+
+    if (world.rank() == 0)
+        print("\nTest apply computed by the owners of the result, type =", archive::get_type_name<T>());
+
+    FunctionDefaults<3>::set_cubic_cell(-20,20);
+    FunctionDefaults<3>::set_k(8);
+    FunctionDefaults<3>::set_initial_level(5);
+    const double expnt = 1.e2;
+    const double coeff = pow(expnt/constants::pi,1.5);
+    Function<T,3> f = FunctionFactory<T,3>(world).functor(functorT(new Gaussian<T,3>(coordT(0.5), expnt, coeff)));
+    f.truncate();
+    SeparatedConvolution<T,3> op = BSHOperator<3>(world, 1.0, 1e-4, 1e-6);
+
+    std::vector<Function<T,3> > result(2);
+    for (int owner=0; owner<2; ++owner) {
+        op.owner_computes() = owner;
+        world.gop.fence();
+        CounterRegistry::reset();
+        double start = wall_time();
+        result[owner] = op(f);
+        double time = wall_time() - start;
+        std::uint64_t nbytes = 0;
+        for (const auto& c : CounterRegistry::sum(world))
+            if (c.first.find("mra.apply.bytes_sent_level") == 0) nbytes += c.second;
+        if (world.rank() == 0) print(owner ? "   owner computes" : "             push", "time", time, "bytes sent", nbytes);
+    }
+
+    double diff = (result[0] - result[1]).norm2();
+    double norm = result[0].norm2();
+    if (world.rank() == 0) print("   difference of the results", diff);
+    world.gop.fence();
+    return (diff < 1.e-10*norm) ? 0 : 1;
+}
+
 
 int main(int argc, char**argv) {
     initialize(argc,argv);
@@ -189,6 +305,9 @@ int main(int argc, char**argv) {
         std::cout << "small test : " << smalltest << std::endl;
 
         success=test_bsh<double>(world);
+        success+=test_combine_accumulation<double>(world);
+        success+=test_screened_displacements<double>(world);
+        success+=test_owner_computes<double>(world);
 
     }
     catch (const SafeMPI::Exception& e) {
@@ -670,6 +670,7 @@ int test_diff(World& world) {
 
 namespace madness {
     extern bool test_rnlp();
+    extern bool test_deferred_accumulation(World& world);
 }
 
 template <typename T, std::size_t NDIM>
@@ -1352,6 +1353,13 @@ int main(int argc, char**argv) {
         MADNESS_CHECK((gg-hh).normf() < 1e-13);
         if (world.rank() == 0) print(" generic and gaussian operator kernels agree\n");
 
+        if (test_deferred_accumulation(world)) {
+            if (world.rank() == 0) print("test_deferred_accumulation  OK\n");
+        } else {
+            if (world.rank() == 0) print("test_deferred_accumulation  FAIL\n");
+            nfail++;
+        }
+
         // disabling to allow tests pass
         // TODO fix this test, sometimes error will increase by several orders of magnitude during propagation
         //nfail+=test_qm(world);
@@ -356,6 +356,54 @@ void test_matrix_mul_sparse(World &world) {
 
 
 
+/// test the screening of disjoint pairs in mul_sparse and matrix_mul_sparse
+template<typename T, int NDIM>
+void test_mul_sparse_screened(World &world) {
+    typedef std::shared_ptr<FunctionFunctorInterface<T, NDIM> > ffunctorT;
+    typedef Vector<double,NDIM> coordT;
+
+    if (world.rank()==0) print("entering test_mul_sparse_screened");
+    const double thresh = 1.e-6;
+    FunctionDefaults<NDIM>::set_cubic_cell(-20.0,20.0);
+    FunctionDefaults<NDIM>::set_k(8);
+    FunctionDefaults<NDIM>::set_thresh(thresh);
+    FunctionDefaults<NDIM>::set_refine(true);
+    FunctionDefaults<NDIM>::set_initial_level(3);
+    FunctionDefaults<NDIM>::set_truncate_mode(1);
+
+    // well-separated localized functions: only the diagonal pairs overlap
+    const long n = 3;
+    std::vector<Function<T, NDIM> > f(n), g(n);
+    for (long i = 0; i < n; ++i) {
+        coordT center(-10.0+10.0*i);
+        f[i] = FunctionFactory<T, NDIM>(world).functor(ffunctorT(new Gaussian<T,NDIM>(center,4.0,1.0)));
+        g[i] = FunctionFactory<T, NDIM>(world).functor(ffunctorT(new Gaussian<T,NDIM>(center,3.0,1.0)));
+    }
+    std::vector<SpatialSummary<NDIM> > fsummary=spatial_summary(world,f,thresh);
+    std::vector<SpatialSummary<NDIM> > gsummary=spatial_summary(world,g,thresh);
+    for (long i = 0; i < n; ++i) {
+        for (long j = 0; j < n; ++j) {
+            MADNESS_CHECK(fsummary[i].overlaps(gsummary[j])==(i==j));
+        }
+    }
+
+    auto result = matrix_mul_sparse<T, T, NDIM>(world, f, g, thresh);
+    for (long i = 0; i < n; ++i) {
+        std::vector<Function<T, NDIM> > result1 = mul_sparse(world, f[i], g, thresh);
+        for (long j = 0; j < n; ++j) {
+            Function<T, NDIM> tmp = f[i] * g[j];
+            double err=(tmp-result[i][j]).norm2();
+            double err1=(tmp-result1[j]).norm2();
+            if (world.rank()==0) print("i, j, error in matrix_mul_sparse, mul_sparse",i,j,err,err1);
+            MADNESS_CHECK(err<10.0*thresh);
+            MADNESS_CHECK(err1<10.0*thresh);
+        }
+    }
+
+    if (world.rank()==0) print("leaving test_mul_sparse_screened");
+}
+
+
 template <std::size_t NDIM>
 void test_multi_to_multi_op(World& world) {
 
@@ -430,6 +478,8 @@ int main(int argc, char**argv) {
 
         test_matrix_mul_sparse<double,2>(world);
         test_matrix_mul_sparse<double,3>(world);
+        test_mul_sparse_screened<double,1>(world);
+        test_mul_sparse_screened<double,3>(world);
 
         if (!smalltest) test_multi_to_multi_op<3>(world);
 #if !HAVE_GENTENSOR
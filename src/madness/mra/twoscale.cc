@@ -41,6 +41,7 @@ using std::ios;
 using std::abs;
 
 #include <madness/mra/twoscale.h>
+#include <madness/mra/mratables.h>
 #include <madness/tensor/tensor.h>
 #include <madness/misc/misc.h>
 
@@ -49,7 +50,7 @@ using std::abs;
 
 namespace madness {
 
-    static const int kmax = 60;
+    static const int kmax = MRATables::kmax;
     static const char *twoscale_filename = "coeffs";  // Will be overridden by load_coeffs
     static const char *autocorr_filename = "autocorr";  // Will be overriden by load_coeff
 
@@ -193,7 +194,7 @@ namespace madness {
 
     // BELOW HERE THE AUTOCORRELATION ROUTINES
 
-    static const int kmax_autoc = 30;
+    static const int kmax_autoc = MRATables::kautoc;
     static int kread = -1;  // value of k for data read from disk into _cread
     static Tensor<double> _cread;
 
@@ -299,6 +300,23 @@ namespace madness {
         return true;
     }
 
+    /// Cache the twoscale & autocorrelation coefficients of the binary tables (not collective)
+
+    /// The cached tensors are views of the mapped file.  Does nothing if the
+    /// coefficients are already loaded.
+    void load_coeffs(const MRATables& tables) {
+        if (loaded) return;
+        for (int k=1; k<=kmax; ++k) {
+            cache[k].h0 = tables.twoscale(k,0);
+            cache[k].h1 = tables.twoscale(k,1);
+            cache[k].g0 = tables.twoscale(k,2);
+            cache[k].g1 = tables.twoscale(k,3);
+        }
+        _cread = tables.autocorr();
+        kread = kmax_autoc;
+        loaded = true;
+    }
+
     /// Collective routine to load and cache twoscale & autorrelation coefficients
 
     /// Only process rank 0 will access the files.
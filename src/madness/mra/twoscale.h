@@ -38,7 +38,10 @@
 #include <madness/world/MADworld.h>
 
 namespace madness {
+    class MRATables;
+
     extern void load_coeffs(World& world, const char* dir);
+    extern void load_coeffs(const MRATables& tables);
     extern bool two_scale_coefficients(int k,
                                            Tensor<double>* h0, Tensor<double>* h1,
                                            Tensor<double>* g0, Tensor<double>* g1);
@@ -901,7 +901,79 @@ namespace madness {
         return vmulXX(a, v, 0.0, fence);
     }
 
+    /// Computes the spatial summaries of a vector of functions
+
+    /// Boxes with coefficients whose norm exceeds tol are considered significant.
+    /// One local pass over each tree and a single global reduction.
+    template <typename T, std::size_t NDIM>
+    std::vector<SpatialSummary<NDIM> > spatial_summary(World& world,
+                                                      const std::vector< Function<T,NDIM> >& v,
+                                                      const double tol) {
+        typedef SpatialSummary<NDIM> summaryT;
+        const std::size_t n=v.size();
+        std::vector<summaryT> result(n);
+        if (n==0) return result;
+
+        std::vector<double> lo(n*NDIM), hi(n*NDIM);
+        std::vector<uint64_t> bits(n*summaryT::nword);
+        for (std::size_t i=0; i<n; ++i) {
+            result[i]=v[i].get_impl()->local_spatial_summary(tol);
+            for (std::size_t d=0; d<NDIM; ++d) {
+                lo[i*NDIM+d]=result[i].lo[d];
+                hi[i*NDIM+d]=result[i].hi[d];
+            }
+            for (int w=0; w<summaryT::nword; ++w) bits[i*summaryT::nword+w]=result[i].bits[w];
+        }
+        world.gop.min(lo.data(),lo.size());
+        world.gop.max(hi.data(),hi.size());
+        world.gop.bit_or(bits.data(),bits.size());
+
+        for (std::size_t i=0; i<n; ++i) {
+            for (std::size_t d=0; d<NDIM; ++d) {
+                result[i].lo[d]=lo[i*NDIM+d];
+                result[i].hi[d]=hi[i*NDIM+d];
+            }
+            for (int w=0; w<summaryT::nword; ++w) result[i].bits[w]=bits[i*summaryT::nword+w];
+        }
+        return result;
+    }
+
+    /// Multiplies a function against a vector of functions, skipping the pairs with
+    /// non-overlapping spatial summaries --- q[i] = a * v[i]
+
+    /// Assumes a and v are reconstructed and have norm trees. A box of a is significant if
+    /// its product with the largest v[i] may exceed tol, and vice versa.
+    template <typename T, typename R, std::size_t NDIM>
+    std::vector< Function<TENSOR_RESULT_TYPE(T,R), NDIM> >
+    vmulXX_screened(World& world,
+                    const Function<T,NDIM>& a,
+                    const std::vector< Function<R,NDIM> >& v,
+                    const SpatialSummary<NDIM>& asummary,
+                    const std::vector<SpatialSummary<NDIM> >& vsummary,
+                    double tol,
+                    bool fence) {
+        typedef TENSOR_RESULT_TYPE(T,R) resultT;
+        std::vector< Function<resultT,NDIM> > result(v.size());
+        std::vector< Function<R,NDIM> > vsignificant;
+        std::vector<std::size_t> index;
+        for (std::size_t i=0; i<v.size(); ++i) {
+            if (asummary.overlaps(vsummary[i])) {
+                vsignificant.push_back(v[i]);
+                index.push_back(i);
+            } else {
+                result[i]=Function<resultT,NDIM>(FunctionFactory<resultT,NDIM>(world)
+                        .k(a.k()).pmap(a.get_pmap()).fence(false));
+            }
+        }
+        std::vector< Function<resultT,NDIM> > r=vmulXX(a, vsignificant, tol, false);
+        for (std::size_t i=0; i<index.size(); ++i) result[index[i]]=r[i];
+        if (fence) world.gop.fence();
+        return result;
+    }
+
     /// Multiplies a function against a vector of functions using sparsity of a and v[i] --- q[i] = a * v[i]
+
+    /// Pairs of functions with disjoint significant regions are skipped before any task is spawned
     template <typename T, typename R, std::size_t NDIM>
     std::vector< Function<TENSOR_RESULT_TYPE(T,R), NDIM> >
     mul_sparse(World& world,
@@ -917,7 +989,14 @@ namespace madness {
             v[i].norm_tree(false);
         }
         a.norm_tree();
-        return vmulXX(a, v, tol, fence);
+        if (tol==0.0 or v.size()==0) return vmulXX(a, v, tol, fence);
+
+        std::vector<double> vnorm=norm2s(world,v);
+        const double vmax=std::max(1.e-300,*std::max_element(vnorm.begin(),vnorm.end()));
+        const double anorm=std::max(1.e-300,a.norm2());
+        SpatialSummary<NDIM> asummary=spatial_summary(world,std::vector< Function<T,NDIM> >(1,a),tol/vmax)[0];
+        std::vector<SpatialSummary<NDIM> > vsummary=spatial_summary(world,v,tol/anorm);
+        return vmulXX_screened(world, a, v, asummary, vsummary, tol, fence);
     }
 
 
@@ -949,7 +1028,20 @@ namespace madness {
         world.gop.fence();
 
         std::vector<std::vector<Function<R,NDIM> > >result(f.size());
-        for (std::size_t i=0; i<f.size(); ++i) result[i]= vmulXX(f[i], g, tol, false);
+        if (tol==0.0 or f.size()==0 or g.size()==0) {
+            for (std::size_t i=0; i<f.size(); ++i) result[i]= vmulXX(f[i], g, tol, false);
+        } else {
+            // skip pairs with disjoint significant regions
+            std::vector<double> fnorm=norm2s(world,f);
+            std::vector<double> gnorm=norm2s(world,g);
+            const double fmax=std::max(1.e-300,*std::max_element(fnorm.begin(),fnorm.end()));
+            const double gmax=std::max(1.e-300,*std::max_element(gnorm.begin(),gnorm.end()));
+            std::vector<SpatialSummary<NDIM> > fsummary=spatial_summary(world,f,tol/gmax);
+            std::vector<SpatialSummary<NDIM> > gsummary=spatial_summary(world,g,tol/fmax);
+            for (std::size_t i=0; i<f.size(); ++i) {
+                result[i]=vmulXX_screened(world, f[i], g, fsummary[i], gsummary, tol, false);
+            }
+        }
         if (fence) world.gop.fence();
         return result;
     }
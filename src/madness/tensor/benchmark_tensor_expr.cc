@@ -0,0 +1,75 @@
+/*
+ * benchmark_tensor_expr.cc
+ *
+ * times chains of elementwise tensor operations as computed by the tensor
+ * operators and as expressions (see tensor_expr.h), for boxes of k^3 and k^6
+ * coefficients; the traffic counts one read or write of each element of each
+ * tensor involved, temporaries included
+ */
+
+#include <madness/tensor/tensor.h>
+#include <madness/tensor/tensor_expr.h>
+#include <madness/world/timers.h>
+#include <madness/world/print.h>
+#include <functional>
+#include <vector>
+
+using namespace madness;
+
+/// seconds per call of \c f
+static double time_call(const std::function<void()>& f, long nrep) {
+    f();
+    const double wall = wall_time();
+    for (long i=0; i<nrep; ++i) f();
+    return (wall_time() - wall)/nrep;
+}
+
+static void report(const char* name, long size, double told, long nold, double tnew, long nnew) {
+    const double gb = 8.0*size*1e-9;
+    print(name, "  size", size);
+    print("   operators  ", told, "s", nold*gb/told, "GB/s", nold, "passes over the data");
+    print("   expression ", tnew, "s", nnew*gb/tnew, "GB/s", nnew, "passes over the data");
+}
+
+static void benchmark(int k, int ndim) {
+    const std::vector<long> dims(ndim, k);
+    Tensor<double> a(dims), b(dims), c(dims), d(dims), r;
+    a.fillrandom();
+    b.fillrandom();
+    c.fillrandom();
+    d.fillrandom();
+    const double alpha = 0.5, beta = -2.0;
+    const long nrep = std::max(1l, 20000000l/a.size());
+
+    // gaxpy out of place
+    double told = time_call([&]() {r = a*alpha + b*beta;}, nrep);
+    double tnew = time_call([&]() {r = evaluate(expr(a)*alpha + expr(b)*beta);}, nrep);
+    report("r = a*alpha + b*beta", a.size(), told, 7, tnew, 3);
+
+    // as in FunctionImpl::assemble_coefficients
+    told = time_call([&]() {r = copy(a); r.emul(b); r += c;}, nrep);
+    tnew = time_call([&]() {r = evaluate(expr(a)*expr(b) + expr(c));}, nrep);
+    report("r = a.emul(b) + c", a.size(), told, 8, tnew, 4);
+
+    told = time_call([&]() {r = a*alpha + b*beta; r.emul(c); r = r - d;}, nrep);
+    tnew = time_call([&]() {r = evaluate((expr(a)*alpha + expr(b)*beta)*expr(c) - expr(d));}, nrep);
+    report("r = (a*alpha + b*beta).emul(c) - d", a.size(), told, 13, tnew, 5);
+
+    // inplace into an existing result
+    r = copy(d);
+    told = time_call([&]() {Tensor<double> t = copy(a); t.emul(b); r.gaxpy(1.0, t, alpha);}, nrep);
+    tnew = time_call([&]() {accumulate(r, expr(a)*expr(b)*alpha);}, nrep);
+    report("r += alpha*a.emul(b)", a.size(), told, 8, tnew, 4);
+}
+
+int main(int argc, char** argv) {
+    for (int k : {8, 10, 14}) {
+        print("\nk", k, "3D");
+        benchmark(k, 3);
+    }
+    for (int k : {6, 10}) {
+        print("\nk", k, "6D");
+        benchmark(k, 6);
+    }
+    return 0;
+}
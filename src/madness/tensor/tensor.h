@@ -543,6 +543,25 @@ namespace madness {
             allocate(nd,d,dozero);
         }
 
+#ifndef TENSOR_USE_SHARED_ALIGNED_ARRAY
+        /// Create a tensor viewing contiguous memory owned by another object
+
+        /// No data is copied.  The tensor (and its shallow copies) share
+        /// ownership of \c owner, which keeps the memory at \c p alive.
+        /// @param[in] nd Number of dimensions
+        /// @param[in] d Size of each dimension
+        /// @param[in] p First element of the data, suitably aligned for \c T
+        /// @param[in] owner Owner of the memory at \c p
+        template <typename ownerT>
+        Tensor(long nd, const long d[], T* p, const std::shared_ptr<ownerT>& owner) : _p(0) {
+            _id = TensorTypeData<T>::id;
+            TENSOR_ASSERT(nd>0 && nd <= TENSOR_MAXDIM,"invalid ndim in new tensor", nd, 0);
+            set_dims_and_size(nd, d);
+            _p = p;
+            _shptr = std::shared_ptr<T>(owner, p);
+        }
+#endif
+
         /// Inplace fill tensor with scalar
 
         /// @param[in] x Value used to fill tensor via assigment
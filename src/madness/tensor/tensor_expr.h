@@ -0,0 +1,304 @@
+/*
+  This file is part of MADNESS.
+
+  Copyright (C) 2007,2010 Oak Ridge National Laboratory
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+
+  For more information please contact:
+
+  Robert J. Harrison
+  Oak Ridge National Laboratory
+  One Bethel Valley Road
+  P.O. Box 2008, MS-6367
+
+  email: harrisonrj@ornl.gov
+  tel:   865-241-3937
+  fax:   865-572-0680
+*/
+
+#ifndef MADNESS_TENSOR_TENSOR_EXPR_H__INCLUDED
+#define MADNESS_TENSOR_TENSOR_EXPR_H__INCLUDED
+
+/// \file tensor_expr.h
+/// \brief Elementwise tensor expressions evaluated in a single pass
+/// \ingroup tensor
+
+#include <madness/tensor/tensor.h>
+
+namespace madness {
+
+    /// \addtogroup tensor
+    /// @{
+
+    /// Elementwise tensor expressions
+
+    /// Each of \c a*alpha, \c a+b and \c a.emul(b) on tensors makes a new
+    /// tensor, so a chain such as \c (a*alpha+b*beta).emul(c) allocates and
+    /// writes three temporaries and reads them back.  Wrapping the operands
+    /// with \c expr() builds the chain as an expression instead, which is
+    /// computed by \c evaluate, \c assign or \c accumulate in one loop over
+    /// the elements, without temporaries:
+    /// \code
+    /// Tensor<double> r = evaluate((expr(a)*alpha + expr(b)*beta) * expr(c));
+    /// accumulate(r, expr(a)*expr(b));      // r += a*b elementwise
+    /// \endcode
+    /// \c * between two expressions is the elementwise product.  The
+    /// operands must conform.  The single loop is used if all operands (and
+    /// the result of \c assign and \c accumulate) are contiguous; otherwise
+    /// each operation is computed as by the tensor operators, with the
+    /// iterators over non-contiguous tensors and with temporaries.
+    ///
+    /// Expressions hold shallow copies of the operands, so they may outlive
+    /// the tensors they were made from.  The result may be one of the
+    /// operands, since each element of the result depends only on the
+    /// elements at the same position.
+    template <typename exprT>
+    class TensorExpression {
+    public:
+        const exprT& self() const {return static_cast<const exprT&>(*this);}
+    };
+
+    /// A tensor as operand of an expression
+    template <typename T>
+    class TensorExprLeaf : public TensorExpression< TensorExprLeaf<T> > {
+        Tensor<T> t;
+        const T* p;
+    public:
+        typedef T resultT;
+
+        explicit TensorExprLeaf(const Tensor<T>& t) : t(t), p(t.ptr()) {}
+
+        T operator[](long i) const {return p[i];}
+
+        bool iscontiguous() const {return t.iscontiguous();}
+
+        const BaseTensor* shape() const {return &t;}
+
+        bool conforms(const BaseTensor* s) const {return t.BaseTensor::conforms(s);}
+
+        const Tensor<T>& tensor() const {return t;}
+    };
+
+    namespace detail {
+
+        struct expr_plus {
+            template <typename L, typename R>
+            static auto apply(const L& l, const R& r) {return l + r;}
+        };
+
+        struct expr_minus {
+            template <typename L, typename R>
+            static auto apply(const L& l, const R& r) {return l - r;}
+        };
+
+        struct expr_multiplies {
+            template <typename L, typename R>
+            static auto apply(const L& l, const R& r) {return l * r;}
+        };
+
+        /// Fills \c r with the elements of \c e, both contiguous and conforming
+        template <typename T, typename exprT>
+        void expr_assign(T* r, long n, const exprT& e) {
+            for (long i=0; i<n; ++i) r[i] = e[i];
+        }
+
+        /// Adds the elements of \c e to \c r, both contiguous and conforming
+        template <typename T, typename exprT>
+        void expr_accumulate(T* r, long n, const exprT& e) {
+            for (long i=0; i<n; ++i) r[i] += e[i];
+        }
+
+        /// The tensor itself, shallow
+        template <typename T>
+        Tensor<T> expr_evaluate(const TensorExprLeaf<T>& e) {
+            return e.tensor();
+        }
+
+        /// The result of \c e in a new tensor, fused if \c e is contiguous
+        template <typename exprT>
+        Tensor<typename exprT::resultT> expr_evaluate(const exprT& e) {
+            typedef typename exprT::resultT resultT;
+            const BaseTensor* s = e.shape();
+            TENSOR_ASSERT(e.conforms(s), "operands of expression do not conform", 0, s);
+            if (not e.iscontiguous()) return e.tensor();
+            Tensor<resultT> result(s->ndim(), s->dims(), false);
+            expr_assign(result.ptr(), result.size(), e);
+            return result;
+        }
+    }
+
+    /// Elementwise binary operation of two expressions
+    template <typename L, typename R, typename opT>
+    class TensorExprBinary : public TensorExpression< TensorExprBinary<L,R,opT> > {
+        L l;
+        R r;
+    public:
+        typedef TENSOR_RESULT_TYPE(typename L::resultT, typename R::resultT) resultT;
+
+        TensorExprBinary(const L& l, const R& r) : l(l), r(r) {}
+
+        resultT operator[](long i) const {return opT::apply(l[i], r[i]);}
+
+        bool iscontiguous() const {return l.iscontiguous() and r.iscontiguous();}
+
+        const BaseTensor* shape() const {return l.shape();}
+
+        bool conforms(const BaseTensor* s) const {return l.conforms(s) and r.conforms(s);}
+
+        /// The result, with one temporary per non-contiguous operation
+        Tensor<resultT> tensor() const {
+            typedef typename L::resultT leftT;
+            typedef typename R::resultT rightT;
+            const Tensor<leftT> a = detail::expr_evaluate(l);
+            const Tensor<rightT> b = detail::expr_evaluate(r);
+            Tensor<resultT> result(a.ndim(), a.dims(), false);
+            TERNARY_OPTIMIZED_ITERATOR(resultT, result, const leftT, a, const rightT, b,
+                                       *_p0 = opT::apply(*_p1, *_p2));
+            return result;
+        }
+    };
+
+    /// An expression multiplied by a scalar
+    template <typename exprT, typename Q>
+    class TensorExprScale : public TensorExpression< TensorExprScale<exprT,Q> > {
+        exprT e;
+        Q x;
+    public:
+        typedef TENSOR_RESULT_TYPE(typename exprT::resultT, Q) resultT;
+
+        TensorExprScale(const exprT& e, const Q& x) : e(e), x(x) {}
+
+        resultT operator[](long i) const {return e[i] * x;}
+
+        bool iscontiguous() const {return e.iscontiguous();}
+
+        const BaseTensor* shape() const {return e.shape();}
+
+        bool conforms(const BaseTensor* s) const {return e.conforms(s);}
+
+        /// The result, with one temporary per non-contiguous operation
+        Tensor<resultT> tensor() const {
+            typedef typename exprT::resultT argT;
+            const Tensor<argT> a = detail::expr_evaluate(e);
+            Tensor<resultT> result(a.ndim(), a.dims(), false);
+            BINARY_OPTIMIZED_ITERATOR(resultT, result, const argT, a, *_p0 = *_p1 * x);
+            return result;
+        }
+    };
+
+    /// Wraps a tensor (or a slice) as operand of an expression
+    template <typename T>
+    TensorExprLeaf<T> expr(const Tensor<T>& t) {
+        return TensorExprLeaf<T>(t);
+    }
+
+    /// Elementwise sum of two expressions
+    template <typename L, typename R>
+    TensorExprBinary<L,R,detail::expr_plus>
+    operator+(const TensorExpression<L>& l, const TensorExpression<R>& r) {
+        return TensorExprBinary<L,R,detail::expr_plus>(l.self(), r.self());
+    }
+
+    /// Elementwise difference of two expressions
+    template <typename L, typename R>
+    TensorExprBinary<L,R,detail::expr_minus>
+    operator-(const TensorExpression<L>& l, const TensorExpression<R>& r) {
+        return TensorExprBinary<L,R,detail::expr_minus>(l.self(), r.self());
+    }
+
+    /// Elementwise product of two expressions, cf. Tensor::emul
+    template <typename L, typename R>
+    TensorExprBinary<L,R,detail::expr_multiplies>
+    operator*(const TensorExpression<L>& l, const TensorExpression<R>& r) {
+        return TensorExprBinary<L,R,detail::expr_multiplies>(l.self(), r.self());
+    }
+
+    /// Expression multiplied by a scalar of a supported type
+    template <typename exprT, typename Q>
+    typename IsSupported<TensorTypeData<Q>, TensorExprScale<exprT,Q> >::type
+    operator*(const TensorExpression<exprT>& e, const Q& x) {
+        return TensorExprScale<exprT,Q>(e.self(), x);
+    }
+
+    /// Scalar of a supported type multiplied by an expression
+    template <typename exprT, typename Q>
+    typename IsSupported<TensorTypeData<Q>, TensorExprScale<exprT,Q> >::type
+    operator*(const Q& x, const TensorExpression<exprT>& e) {
+        return TensorExprScale<exprT,Q>(e.self(), x);
+    }
+
+    /// Negated expression
+    template <typename exprT>
+    TensorExprScale<exprT, typename exprT::resultT>
+    operator-(const TensorExpression<exprT>& e) {
+        typedef typename exprT::resultT resultT;
+        return TensorExprScale<exprT,resultT>(e.self(), resultT(-1));
+    }
+
+    /// Returns a new contiguous tensor with the result of the expression
+    template <typename exprT>
+    Tensor<typename exprT::resultT> evaluate(const TensorExpression<exprT>& e) {
+        return detail::expr_evaluate(e.self());
+    }
+
+    /// Returns a deep copy of a tensor wrapped by \c expr()
+    template <typename T>
+    Tensor<T> evaluate(const TensorExprLeaf<T>& e) {
+        return copy(e.tensor());
+    }
+
+    /// Inplace assignment of the result of an expression to a conforming tensor or slice
+
+    /// An empty \c result is assigned a new tensor.
+    /// @return %Reference to \c result
+    template <typename T, typename exprT>
+    Tensor<T>& assign(Tensor<T>& result, const TensorExpression<exprT>& e) {
+        typedef typename exprT::resultT resultT;
+        const exprT& x = e.self();
+        if (not result.has_data()) return result = evaluate(e);
+        TENSOR_ASSERT(x.conforms(&result), "expression does not conform to result", 0, &result);
+        if (result.iscontiguous() and x.iscontiguous()) {
+            detail::expr_assign(result.ptr(), result.size(), x);
+        }
+        else {
+            const Tensor<resultT> a = detail::expr_evaluate(x);
+            BINARY_OPTIMIZED_ITERATOR(T, result, const resultT, a, *_p0 = *_p1);
+        }
+        return result;
+    }
+
+    /// Inplace addition of the result of an expression to a conforming tensor or slice
+
+    /// @return %Reference to \c result
+    template <typename T, typename exprT>
+    Tensor<T>& accumulate(Tensor<T>& result, const TensorExpression<exprT>& e) {
+        typedef typename exprT::resultT resultT;
+        const exprT& x = e.self();
+        TENSOR_ASSERT(x.conforms(&result), "expression does not conform to result", 0, &result);
+        if (result.iscontiguous() and x.iscontiguous()) {
+            detail::expr_accumulate(result.ptr(), result.size(), x);
+        }
+        else {
+            const Tensor<resultT> a = detail::expr_evaluate(x);
+            BINARY_OPTIMIZED_ITERATOR(T, result, const resultT, a, *_p0 += *_p1);
+        }
+        return result;
+    }
+
+    /// @}
+}
+
+#endif // MADNESS_TENSOR_TENSOR_EXPR_H__INCLUDED
@@ -33,6 +33,7 @@
 /// \brief New test code for Tensor class using Google unit test
 
 #include <madness/tensor/tensor.h>
+#include <madness/tensor/tensor_expr.h>
 #include <madness/world/print.h>
 
 #ifdef MADNESS_HAS_GOOGLE_TEST
@@ -415,6 +416,63 @@ namespace {
         ITERATOR3(b,ASSERT_EQ(b(_i,_j,_k), a(_j,_i,_k)));
     }
 
+    TYPED_TEST(TensorTest, Expressions) {
+        const TypeParam alpha(2), beta(3);
+        madness::Tensor<TypeParam> a(5,6,7), b(5,6,7), c(5,6,7), r;
+        a.fillindex();
+        b.fillindex();
+        b.scale(TypeParam(-1));
+        c.fill(TypeParam(2));
+        c(0,_,_) = TypeParam(5);
+
+        // contiguous operands, single loop
+        r = evaluate((expr(a)*alpha + beta*expr(b)) * expr(c) - expr(a));
+        ITERATOR3(r,ASSERT_EQ(r(IND3), (a(IND3)*alpha + beta*b(IND3))*c(IND3) - a(IND3)));
+        r = evaluate(-expr(a));
+        ITERATOR3(r,ASSERT_EQ(r(IND3), -a(IND3)));
+        r = evaluate(expr(a));
+        ASSERT_NE(r.ptr(), a.ptr());
+        ITERATOR3(r,ASSERT_EQ(r(IND3), a(IND3)));
+
+        // non-contiguous operands, operation by operation
+        madness::Tensor<TypeParam> as = a.swapdim(0,2), bs = b.swapdim(0,2), cs = c.swapdim(0,2);
+        ASSERT_FALSE(as.iscontiguous());
+        r = evaluate(expr(as)*expr(bs) + expr(cs)*alpha);
+        ITERATOR3(r,ASSERT_EQ(r(IND3), as(IND3)*bs(IND3) + cs(IND3)*alpha));
+        madness::Tensor<TypeParam> cc(5,6,14);
+        cc(_,_,madness::Slice(0,-1,2)) = c;
+        madness::Tensor<TypeParam> cstride = cc(_,_,madness::Slice(0,-1,2));
+        ASSERT_FALSE(cstride.iscontiguous());
+        r = evaluate(expr(a)*expr(b) + expr(cstride)*alpha - (expr(a) + expr(b)));
+        ITERATOR3(r,ASSERT_EQ(r(IND3), a(IND3)*b(IND3) + c(IND3)*alpha - (a(IND3) + b(IND3))));
+
+        // assignment and accumulation into contiguous tensors and slices
+        madness::Tensor<TypeParam> d(5,6,7), e = copy(a);
+        assign(d, expr(a) + expr(b)*expr(c));
+        ITERATOR3(d,ASSERT_EQ(d(IND3), a(IND3) + b(IND3)*c(IND3)));
+        accumulate(d, expr(a)*alpha);
+        ITERATOR3(d,ASSERT_EQ(d(IND3), a(IND3)*(alpha + TypeParam(1)) + b(IND3)*c(IND3)));
+        madness::Tensor<TypeParam> ds = d.swapdim(0,2);
+        assign(ds, expr(as)*beta);
+        ITERATOR3(ds,ASSERT_EQ(ds(IND3), as(IND3)*beta));
+        accumulate(ds, expr(as) + expr(bs));
+        ITERATOR3(d,ASSERT_EQ(d(IND3), a(IND3)*(beta + TypeParam(1)) + b(IND3)));
+
+        // the result may be an operand
+        assign(e, expr(e)*alpha + expr(b));
+        ITERATOR3(e,ASSERT_EQ(e(IND3), a(IND3)*alpha + b(IND3)));
+
+        // an empty result gets a new tensor
+        madness::Tensor<TypeParam> f;
+        assign(f, expr(a)*expr(c));
+        ITERATOR3(f,ASSERT_EQ(f(IND3), a(IND3)*c(IND3)));
+
+        // operands must conform
+        madness::Tensor<TypeParam> wrong(5,7,6);
+        ASSERT_THROW(evaluate(expr(a) + expr(wrong)), madness::TensorException);
+        ASSERT_THROW(assign(d, expr(wrong)*alpha), madness::TensorException);
+    }
+
 //     TYPED_TEST(TensorTest, Container) {
 //         typedef madness::ConcurrentHashMap< int, Tensor<TypeParam> > containerT;
 //         static const int N = 100;
@@ -12,7 +12,9 @@
 
 
 #include <madness/world/parallel_dc_archive.h>
+#include <madness/world/world_topology.h>
 #include<any>
+#include<cstdlib>
 #include<iomanip>
 
 
@@ -83,6 +85,22 @@ struct Recordlist {
 
 };
 
+/// maps every key to a fixed process, usually the node leader of the calling process
+
+/// Unlike the usual process maps this one is not the same on all processes:
+/// each process stores and finds its keys on the leader of its own node, so
+/// that a container using it holds one independent copy of the data per node.
+/// Only insert, replace, find and local clear are meaningful for such a
+/// container.
+template<typename keyT>
+class NodeLocalPmap : public WorldDCPmapInterface<keyT> {
+    const ProcessID leader;
+public:
+    explicit NodeLocalPmap(ProcessID leader) : leader(leader) {}
+
+    ProcessID owner(const keyT&) const override {return leader;}
+};
+
 /// cloud class
 
 /// store and load data to/from the cloud into arbitrary worlds
@@ -105,11 +123,26 @@ struct Recordlist {
 ///      do work
 ///  }
 ///  subworld.gop.fence();
+///
+/// Two optional storage features reduce the traffic when many subworlds load
+/// the same records:
+///  - set_replicate(true): a record fetched from a process on another node is
+///    kept in a per-node replica on the lowest rank of that node, so that
+///    other subworlds on the same node find it there instead of going over
+///    the network again. Nodes are told apart by host name; setting the
+///    environment variable MAD_CLOUD_NODE_SIZE=n instead groups blocks of n
+///    consecutive ranks into a node.
+///  - set_compress(true): records are stored byte-shuffled and run-length
+///    encoded if that makes them smaller (see archive::compress_record).
+///
+/// Replica hits and misses and the compression ratio are shown by print_timings.
 class Cloud {
 
     bool debug = false;       ///< prints debug output
     bool dofence = true;      ///< fences after load/store
     bool force_load_from_cache = false;       ///< forces load from cache (mainly for debugging)
+    bool replicate = false;   ///< keep records fetched from other nodes in a per-node replica
+    bool compress = false;    ///< compress records when storing
 
 public:
 
@@ -119,15 +152,18 @@ public:
     typedef Recordlist<keyT> recordlistT;
 
 private:
+    std::vector<long> node_of_rank;     ///< node index of each universe rank
     madness::WorldContainer<keyT, std::vector<unsigned char> > container;
+    mutable madness::WorldContainer<keyT, std::vector<unsigned char> > replica;   ///< per-node copies of remote records
     cacheT cached_objects;
     recordlistT local_list_of_container_keys;   // a world-local list of keys occupied in container
 
 public:
 
     /// @param[in]	universe	the universe world
-    Cloud(madness::World &universe) : container(universe), reading_time(0l), writing_time(0l),
-        cache_reads(0l), cache_stores(0l) {
+    Cloud(madness::World &universe) : node_of_rank(compute_node_of_rank(universe, "MAD_CLOUD_NODE_SIZE")), container(universe),
+        replica(universe, std::make_shared<NodeLocalPmap<keyT>>(node_leader(universe.rank()))),
+        reading_time(0l), writing_time(0l), cache_reads(0l), cache_stores(0l) {
     }
 
     void set_debug(bool value) {
@@ -142,6 +178,16 @@ public:
         force_load_from_cache = value;
     }
 
+    /// keep records fetched from another node in a replica on this node
+    void set_replicate(bool value) {
+        replicate = value;
+    }
+
+    /// compress records stored from now on
+    void set_compress(bool value) {
+        compress = value;
+    }
+
     void print_timings(World &universe) const {
         double rtime = double(reading_time);
         double wtime = double(writing_time);
@@ -151,27 +197,50 @@ public:
         long cstores = long(cache_stores);
         universe.gop.sum(creads);
         universe.gop.sum(cstores);
+        long rhits = long(replica_hits);
+        long rmisses = long(replica_misses);
+        universe.gop.sum(rhits);
+        universe.gop.sum(rmisses);
+        double raw = double(record_sizes.raw);
+        double stored = double(record_sizes.stored);
+        universe.gop.sum(raw);
+        universe.gop.sum(stored);
         if (universe.rank() == 0) {
             auto precision = std::cout.precision();
             std::cout << std::fixed << std::setprecision(1);
             print("cloud storing cpu time", wtime * 0.001);
+            if (compress and stored > 0.0) print("cloud compression     ", raw / stored);
             print("cloud reading cpu time", rtime * 0.001, std::defaultfloat);
             std::cout << std::setprecision(precision) << std::scientific;
             print("cloud cache stores    ", long(cstores));
             print("cloud cache loads     ", long(creads));
+            if (rhits + rmisses > 0) {
+                print("cloud replica hits    ", rhits);
+                print("cloud replica misses  ", rmisses);
+            }
         }
     }
     void clear_cache(World &subworld) {
         cached_objects.clear();
         local_list_of_container_keys.list.clear();
+        replica.clear();
         subworld.gop.fence();
     }
 
+    /// true if the record is in the (process-local) cache
+    bool is_cached(const keyT &key) const {
+        return (cached_objects.count(key) == 1);
+    }
+
     void clear_timings() {
         reading_time=0l;
         writing_time=0l;
         cache_stores=0l;
         cache_reads=0l;
+        replica_hits=0l;
+        replica_misses=0l;
+        record_sizes.raw=0l;
+        record_sizes.stored=0l;
     }
 
     template<typename T>
@@ -204,6 +273,9 @@ private:
     mutable std::atomic<long> writing_time=0l;    // in ms
     mutable std::atomic<long> cache_reads=0l;
     mutable std::atomic<long> cache_stores=0l;
+    mutable std::atomic<long> replica_hits=0l;
+    mutable std::atomic<long> replica_misses=0l;
+    mutable archive::RecordSizes record_sizes;
 
     template<typename>
     struct is_tuple : std::false_type {
@@ -219,6 +291,13 @@ private:
     struct is_madness_function_vector<std::vector<Function<T, NDIM>>> : std::true_type {
     };
 
+    template<typename>
+    struct is_madness_function : std::false_type {
+    };
+    template<typename T, std::size_t NDIM>
+    struct is_madness_function<Function<T, NDIM>> : std::true_type {
+    };
+
     template<typename T> using is_world_constructible = std::is_constructible<T, World &>;
 
     struct cloudtimer {
@@ -234,6 +313,42 @@ private:
     };
 
 
+    /// lowest universe rank on the node of the given rank
+    ProcessID node_leader(ProcessID rank) const {
+        for (ProcessID r = 0; r < rank; ++r) if (node_of_rank[r] == node_of_rank[rank]) return r;
+        return rank;
+    }
+
+    /// get the stored bytes of a record
+
+    /// Records owned by a process on another node are looked up in the node
+    /// replica first; on a miss they are fetched from the owner and added to it.
+    std::vector<unsigned char> fetch_record(World &world, const keyT &record) const {
+        auto find = [&](const madness::WorldContainer<keyT, std::vector<unsigned char> >& dc) {
+            auto it = dc.find(record).get();
+            return (it == dc.end()) ? std::vector<unsigned char>() : it->second;
+        };
+
+        const ProcessID me = container.get_world().rank();
+        const bool remote = replicate and node_of_rank[container.owner(record)] != node_of_rank[me];
+        std::vector<unsigned char> v;
+        if (remote) {
+            v = find(replica);
+            if (not v.empty()) {
+                replica_hits++;
+                return v;
+            }
+            replica_misses++;
+        }
+        v = find(container);
+        if (v.empty()) {
+            std::cout << "key " << record << " in world " << world.id() << std::endl;
+            MADNESS_EXCEPTION("record not found", record);
+        }
+        if (remote) replica.replace(record, v);
+        return v;
+    }
+
     template<typename T>
     void cache(madness::World &world, const T &obj, const keyT &record) const {
         const_cast<cacheT &>(cached_objects).insert({record,std::make_any<T>(obj)});
@@ -260,10 +375,6 @@ private:
         return result;
     }
 
-    bool is_cached(const keyT &key) const {
-        return (cached_objects.count(key) == 1);
-    }
-
     /// checks if a (universe) container record is used
 
     /// currently implemented with a local copy of the recordlist, might be
@@ -293,9 +404,13 @@ private:
         if (is_already_present) {
             if (world.rank()==0) cache_stores++;
         } else {
-            madness::archive::ContainerRecordOutputArchive ar(world, container, record);
-            madness::archive::ParallelOutputArchive<madness::archive::ContainerRecordOutputArchive> par(world, ar);
-            par & source;
+            bool stored = false;
+            if constexpr (is_madness_function<T>::value) stored = store_function_slabs(world, source, record);
+            if (not stored) {
+                madness::archive::ContainerRecordOutputArchive ar(world, container, record, compress, &record_sizes);
+                madness::archive::ParallelOutputArchive<madness::archive::ContainerRecordOutputArchive> par(world, ar);
+                par & source;
+            }
             local_list_of_container_keys+=record;
         }
         if (dofence) world.gop.fence();
@@ -310,13 +425,119 @@ private:
         if (is_cached(record)) return load_from_cache<T>(world, record);
         if (debug) print("loading", typeid(T).name(), "from container record", record, "to world", world.id());
         T target = allocator<T>(world);
-        madness::archive::ContainerRecordInputArchive ar(world, container, record);
+        std::vector<unsigned char> bytes;
+        if (world.rank() == 0) bytes = fetch_record(world, record);
+        if constexpr (is_madness_function<T>::value) {
+            if (load_function_slabs(world, bytes, record, target)) {
+                cache(world, target, record);
+                return target;
+            }
+        }
+        madness::archive::ContainerRecordInputArchive ar(world, std::move(bytes));
         madness::archive::ParallelInputArchive<madness::archive::ContainerRecordInputArchive> par(world, ar);
         par & target;
         cache(world, target, record);
         return target;
     }
 
+    /// first word of the directory record of a Function stored as slabs
+    static constexpr long slab_magic = 7776769;
+
+    /// container record of the slab of process \c rank of a Function stored under \c record
+    static keyT slab_record(const keyT &record, long rank) {
+        hashT h = hash_value(record);
+        hash_combine(h, rank);
+        return keyT(h);
+    }
+
+    /// put a raw record into the container, compressing it if requested
+    void store_record(const keyT &key, std::vector<unsigned char> &v) {
+        const long raw = v.size();
+        if (compress) {
+            std::vector<unsigned char> c = archive::compress_record(v.data(), v.size());
+            if (c.size() < v.size()) v.swap(c);
+        }
+        record_sizes.raw += raw;
+        record_sizes.stored += v.size();
+        container.replace(key, v);
+    }
+
+    /// store a Function as a directory record and one slab of coefficients per process
+
+    /// Every process packs its own nodes into a single contiguous buffer
+    /// (see FunctionImpl::pack_local_nodes) and puts it into the container
+    /// directly, instead of sending the nodes one by one through the
+    /// parallel archive to rank 0.  The directory, written by rank 0, holds
+    /// the type information, the parameters of the FunctionImpl and the
+    /// number of slabs.
+    /// @return false if the Function cannot be stored this way (low-rank coefficients)
+    template<typename T, std::size_t NDIM>
+    bool store_function_slabs(World &world, const Function<T, NDIM> &source, const keyT &record) {
+        const auto impl = source.get_impl();
+        if (not impl or not impl->can_pack_nodes()) return false;
+        world.gop.fence();      // all updates of the coefficients must have completed
+
+        std::vector<unsigned char> slab(16, 0);
+        slab[0] = archive::record_raw;
+        impl->pack_local_nodes(slab);
+        store_record(slab_record(record, world.rank()), slab);
+
+        if (world.rank() == 0) {
+            std::vector<unsigned char> dir;
+            archive::VectorOutputArchive ar(dir);
+            const unsigned char encoding = archive::record_raw;
+            ar.store(&encoding, 1);     // raw, as the magic is checked without the archive
+            ar.store(&slab_magic, 1);
+            ar & long(TensorTypeData<T>::id) & long(NDIM) & long(impl->get_k());
+            impl->store_metadata(ar);
+            ar & long(world.size());
+            store_record(record, dir);
+        }
+        world.gop.fence();
+        return true;
+    }
+
+    /// load a Function stored by store_function_slabs
+
+    /// Collective on \c world.  The slabs are distributed round-robin over
+    /// the processes of \c world, which insert their nodes without copying
+    /// the coefficients (see FunctionImpl::unpack_nodes).
+    /// @param[in]  bytes   the record as fetched by rank 0, ignored on the other ranks
+    /// @return false if the record is not a slab directory (no communication on the data)
+    template<typename T, std::size_t NDIM>
+    bool load_function_slabs(World &world, std::vector<unsigned char> &bytes, const keyT &record,
+                             Function<T, NDIM> &target) const {
+        std::vector<unsigned char> dir;
+        if (world.rank() == 0) {
+            archive::decode_record(bytes);
+            long magic = 0;
+            if (bytes.size() >= 1 + sizeof(magic)) std::memcpy(&magic, &bytes[1], sizeof(magic));
+            if (magic == slab_magic) dir.swap(bytes);
+        }
+        if (world.size() > 1) world.gop.broadcast_serializable(dir, 0);
+        if (dir.empty()) return false;
+
+        archive::VectorInputArchive ar(dir);
+        unsigned char encoding = 0;
+        long magic = 0, id = 0, ndim = 0, k = 0, nslab = 0;
+        ar.load(&encoding, 1);
+        ar.load(&magic, 1);
+        ar & id & ndim & k;
+        MADNESS_CHECK(id == TensorTypeData<T>::id);
+        MADNESS_CHECK(ndim == NDIM);
+        target = FunctionFactory<T, NDIM>(world).k(k).empty();
+        target.get_impl()->load_metadata(ar);
+        ar & nslab;
+
+        for (long i = world.rank(); i < nslab; i += world.size()) {
+            auto slab = std::make_shared<std::vector<unsigned char>>(fetch_record(world, slab_record(record, i)));
+            archive::decode_record(*slab);
+            target.get_impl()->unpack_nodes(slab, 16);
+        }
+        world.gop.fence();
+        return true;
+    }
+
     // overloaded
     template<typename T, std::size_t NDIM>
     recordlistT store_other(madness::World &world, const std::vector<Function<T, NDIM>> &source) {
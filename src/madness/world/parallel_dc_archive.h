@@ -4,13 +4,115 @@
 #include <madness/world/MADworld.h>
 #include <madness/world/worlddc.h>
 #include <madness/world/vector_archive.h>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
 
 namespace madness {
 
 
 
     namespace archive {
-        
+
+        /// Leading byte of a container record, telling how the payload is stored
+        enum RecordEncoding : unsigned char {
+            record_raw = 0,         ///< payload follows verbatim
+            record_compressed = 1   ///< payload is byte-shuffled and run-length encoded
+        };
+
+        /// Compress a (raw) record
+
+        /// The bytes are first shuffled as if the payload were an array of
+        /// 8-byte words (all first bytes, then all second bytes, ...), which
+        /// groups the sign/exponent bytes of double coefficients and the
+        /// zero bytes of small integers, and then run-length encoded
+        /// (PackBits).  Trailing bytes that do not fill a word are kept in
+        /// place.  The result starts with \c record_compressed and the
+        /// uncompressed size.
+        inline std::vector<unsigned char> compress_record(const unsigned char* p, const std::size_t n) {
+            const std::size_t nword = n/8;
+            auto at = [p,n,nword](std::size_t s) -> unsigned char {
+                if (s < 8*nword) return p[(s%nword)*8 + s/nword];
+                return p[s];
+            };
+
+            std::vector<unsigned char> out;
+            out.reserve(n/2 + 16);
+            out.push_back(record_compressed);
+            const std::uint64_t size = n;
+            const unsigned char* psize = reinterpret_cast<const unsigned char*>(&size);
+            out.insert(out.end(), psize, psize + sizeof(size));
+
+            std::size_t i = 0;
+            while (i < n) {
+                std::size_t run = 1;
+                while (i+run < n && run < 128 && at(i+run) == at(i)) ++run;
+                if (run >= 3) {
+                    out.push_back(static_cast<unsigned char>(257 - run));
+                    out.push_back(at(i));
+                    i += run;
+                }
+                else {
+                    const std::size_t start = i;
+                    std::size_t len = 0;
+                    while (i < n && len < 128) {
+                        if (i+2 < n && at(i) == at(i+1) && at(i) == at(i+2)) break;
+                        ++i;
+                        ++len;
+                    }
+                    out.push_back(static_cast<unsigned char>(len - 1));
+                    for (std::size_t s = start; s < start+len; ++s) out.push_back(at(s));
+                }
+            }
+            return out;
+        }
+
+        /// Inverse of \c compress_record; \c c must start with \c record_compressed
+        inline std::vector<unsigned char> decompress_record(const std::vector<unsigned char>& c) {
+            std::uint64_t n = 0;
+            if (c.size() < 1 + sizeof(n) || c[0] != record_compressed)
+                MADNESS_EXCEPTION("decompress_record: not a compressed record", 0);
+            std::memcpy(&n, &c[1], sizeof(n));
+
+            std::vector<unsigned char> shuffled;
+            shuffled.reserve(n);
+            std::size_t i = 1 + sizeof(n);
+            while (i < c.size()) {
+                const unsigned char control = c[i++];
+                if (control < 128) {
+                    const std::size_t len = std::size_t(control) + 1;
+                    if (i + len > c.size()) MADNESS_EXCEPTION("decompress_record: corrupt record", 1);
+                    shuffled.insert(shuffled.end(), c.begin() + i, c.begin() + i + len);
+                    i += len;
+                }
+                else {
+                    if (i >= c.size()) MADNESS_EXCEPTION("decompress_record: corrupt record", 2);
+                    shuffled.insert(shuffled.end(), 257 - std::size_t(control), c[i++]);
+                }
+            }
+            if (shuffled.size() != n) MADNESS_EXCEPTION("decompress_record: size mismatch", 3);
+
+            std::vector<unsigned char> result(n);
+            const std::size_t nword = n/8;
+            for (std::size_t b = 0; b < 8 && nword > 0; ++b)
+                for (std::size_t w = 0; w < nword; ++w) result[w*8 + b] = shuffled[b*nword + w];
+            for (std::size_t s = 8*nword; s < n; ++s) result[s] = shuffled[s];
+            return result;
+        }
+
+        /// Turn a record as stored in the container into the raw record, which starts with \c record_raw
+        inline void decode_record(std::vector<unsigned char>& v) {
+            if (v.empty()) MADNESS_EXCEPTION("empty container record", 0);
+            if (v[0] == record_compressed) v = decompress_record(v);
+            if (v.empty() || v[0] != record_raw) MADNESS_EXCEPTION("unknown container record encoding", 0);
+        }
+
+        /// Accumulated record sizes before and after compression
+        struct RecordSizes {
+            std::atomic<long> raw{0};       ///< bytes as serialized
+            std::atomic<long> stored{0};    ///< bytes as stored in the container
+        };
+
         class ContainerRecordOutputArchive : public BaseOutputArchive {
         public:
             using keyT = long;
@@ -21,16 +123,26 @@ namespace madness {
             containerT& dc; // lifetime???
             std::vector<unsigned char> v;
             VectorOutputArchive ar;
+            bool compress;
+            RecordSizes* sizes;
             
         public:
 
-            ContainerRecordOutputArchive(World& subworld, containerT& dc, const keyT& key)
+            /// \param[in] compress compress the record with \c compress_record if that makes it smaller
+            /// \param[in] sizes if not null, raw and stored record sizes are accumulated here
+            ContainerRecordOutputArchive(World& subworld, containerT& dc, const keyT& key,
+                                         bool compress=false, RecordSizes* sizes=nullptr)
                 : subworld(subworld)
                 , key(key)
                 , dc(dc)
                 , v()
                 , ar(v)
-            {}
+                , compress(compress)
+                , sizes(sizes)
+            {
+                const unsigned char encoding = record_raw;
+                ar.store(&encoding, 1);
+            }
             
             ~ContainerRecordOutputArchive()
             {
@@ -50,7 +162,17 @@ namespace madness {
             void flush() {}
             
             void close() {
-                if (subworld.rank() == 0) dc.replace(key,v);
+                if (subworld.rank() != 0) return;
+                const long raw = v.size();
+                if (compress) {
+                    std::vector<unsigned char> c = compress_record(v.data(), v.size());
+                    if (c.size() < v.size()) v.swap(c);
+                }
+                if (sizes) {
+                    sizes->raw += raw;
+                    sizes->stored += v.size();
+                }
+                dc.replace(key,v);
             }
         };
         
@@ -77,8 +199,20 @@ namespace madness {
                     			<< "dc.world " << dc.get_world().id() << std::endl;
                         MADNESS_EXCEPTION("record not found", key);
                     }
+                    decode();
                 }
             }
+
+            /// Read from a record that has already been fetched from the container
+
+            /// \param[in] record the record as stored in the container, only used on rank 0 of \c subworld
+            ContainerRecordInputArchive(World& subworld, std::vector<unsigned char> record)
+                : rank(subworld.rank())
+                , v(std::move(record))
+                , ar(v)
+            {
+                if (rank==0) decode();
+            }
             
             ~ContainerRecordInputArchive()
             {}
@@ -96,6 +230,14 @@ namespace madness {
             void flush() {}
             
             void close() {}
+
+        private:
+            /// Strip the encoding byte, decompressing the payload if needed
+            void decode() {
+                decode_record(v);
+                unsigned char encoding;
+                ar.load(&encoding, 1);
+            }
         };
         
     }
@@ -0,0 +1,202 @@
+/*
+  This file is part of MADNESS.
+
+  Copyright (C) 2007,2010 Oak Ridge National Laboratory
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+
+  For more information please contact:
+
+  Robert J. Harrison
+  Oak Ridge National Laboratory
+  One Bethel Valley Road
+  P.O. Box 2008, MS-6367
+
+  email: harrisonrj@ornl.gov
+  tel:   865-241-3937
+  fax:   865-572-0680
+*/
+
+
+/// Tests coroutine tasks and compares their cost with TaskFn tasks.
+
+/// Without C++20 coroutine support the test does nothing.  Allocations are
+/// counted by replacing the global operator new.
+
+#include <madness/world/MADworld.h>
+#include <madness/world/world_coroutine.h>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+using namespace madness;
+
+#ifdef MADNESS_HAS_COROUTINES
+
+namespace {
+    std::atomic<std::size_t> nalloc{0};
+    std::atomic<std::size_t> nbyte{0};
+}
+
+void* operator new(std::size_t n) {
+    nalloc.fetch_add(1, std::memory_order_relaxed);
+    nbyte.fetch_add(n, std::memory_order_relaxed);
+    if (void* p = std::malloc(n ? n : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+/// Allocations made between construction and \c stop()
+struct AllocationCount {
+    const std::size_t nalloc0, nbyte0;
+    AllocationCount() : nalloc0(nalloc), nbyte0(nbyte) {}
+    std::pair<std::size_t, std::size_t> stop() const {return {nalloc - nalloc0, nbyte - nbyte0};}
+};
+
+long add_longs(long a, long b) {
+    return a + b;
+}
+
+long identity(long a) {
+    return a;
+}
+
+/// Binary tree of depth \c depth summed with a TaskFn continuation per node, as in compress_spawn
+Future<long> tree_task(World* world, int depth) {
+    if (depth == 0) return Future<long>(1l);
+    Future<long> left = world->taskq.add(tree_task, world, depth-1);
+    Future<long> right = world->taskq.add(tree_task, world, depth-1);
+    return world->taskq.add(add_longs, left, right);
+}
+
+/// The same tree with coroutines
+Coroutine<long> tree_coroutine(World* world, int depth) {
+    if (depth == 0) co_return 1l;
+    Future<long> left = world->taskq.add(tree_coroutine(world, depth-1));
+    Future<long> right = world->taskq.add(tree_coroutine(world, depth-1));
+    co_return co_await left + co_await right;
+}
+
+Coroutine<long> await_one(Future<long> f) {
+    co_return co_await f;
+}
+
+Coroutine<void> set_when_ready(Future<long> a, Future<long> b, Future<long> result) {
+    const long sum = co_await a + co_await b;
+    result.set(sum);
+}
+
+int realmain(World& world) {
+    int nerror = 0;
+
+    // values arriving after the coroutine has suspended
+    {
+        Future<long> c;
+        Future<long> d = world.taskq.add(await_one(c));
+        Future<long> a = world.taskq.add(identity, 3l);
+        Future<long> b = world.taskq.add(identity, 4l);
+        world.taskq.add(set_when_ready(a, b, c));
+        world.gop.fence();
+        if (not d.probe() or d.get() != 7) {
+            print("coroutine: wrong result of dependent coroutines");
+            ++nerror;
+        }
+    }
+
+    // task creation and scheduling: binary tree with a continuation per node
+    const int depth = 14;
+    const long nnode = (1l << (depth+1)) - 1;
+    {
+        world.gop.fence();
+        double t0 = wall_time();
+        AllocationCount count;
+        Future<long> sum = world.taskq.add(tree_task, &world, depth);
+        world.gop.fence();
+        auto [na, nb] = count.stop();
+        double t1 = wall_time();
+        if (sum.get() != (1l << depth)) ++nerror;
+        if (world.rank() == 0) print("TaskFn tree:    ", nnode, "nodes", (t1-t0)/nnode*1e6, "us/node",
+                                     double(na)/nnode, "allocations/node", double(nb)/nnode, "bytes/node");
+    }
+    {
+        world.gop.fence();
+        double t0 = wall_time();
+        AllocationCount count;
+        Future<long> sum = world.taskq.add(tree_coroutine(&world, depth));
+        world.gop.fence();
+        auto [na, nb] = count.stop();
+        double t1 = wall_time();
+        if (sum.get() != (1l << depth)) ++nerror;
+        if (world.rank() == 0) print("Coroutine tree: ", nnode, "nodes", (t1-t0)/nnode*1e6, "us/node",
+                                     double(na)/nnode, "allocations/node", double(nb)/nnode, "bytes/node");
+    }
+
+    // memory held by continuations waiting for one future
+    const long npending = 10000;
+    {
+        Future<long> trigger;
+        std::vector<Future<long>> results(npending);
+        AllocationCount count;
+        for (long i = 0; i < npending; ++i) results[i] = world.taskq.add(identity, trigger);
+        auto [na, nb] = count.stop();
+        trigger.set(1l);
+        world.gop.fence();
+        long sum = 0;
+        for (const auto& r : results) sum += r.get();
+        if (sum != npending) ++nerror;
+        if (world.rank() == 0) print("TaskFn pending:    ", double(na)/npending, "allocations", double(nb)/npending, "bytes per continuation");
+    }
+    {
+        Future<long> trigger;
+        std::vector<Future<long>> results(npending);
+        AllocationCount count;
+        for (long i = 0; i < npending; ++i) results[i] = world.taskq.add(await_one(trigger));
+        auto [na, nb] = count.stop();
+        trigger.set(1l);
+        world.gop.fence();
+        long sum = 0;
+        for (const auto& r : results) sum += r.get();
+        if (sum != npending) ++nerror;
+        if (world.rank() == 0) print("Coroutine pending: ", double(na)/npending, "allocations", double(nb)/npending, "bytes per continuation");
+    }
+
+    world.gop.fence();
+    return nerror;
+}
+
+#else
+
+int realmain(World& world) {
+    if (world.rank() == 0) print("coroutines are not available (requires C++20); test skipped");
+    return 0;
+}
+
+#endif // MADNESS_HAS_COROUTINES
+
+int main(int argc, char** argv) {
+    World& world = initialize(argc,argv);
+    int nerror = realmain(world);
+    world.gop.sum(nerror);
+    if (world.rank() == 0) print(nerror ? "coroutine test FAILED" : "coroutine test passed");
+    finalize();
+    return nerror ? 1 : 0;
+}
@@ -0,0 +1,150 @@
+/*
+  This file is part of MADNESS.
+
+  Copyright (C) 2007,2010 Oak Ridge National Laboratory
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+
+  For more information please contact:
+
+  Robert J. Harrison
+  Oak Ridge National Laboratory
+  One Bethel Valley Road
+  P.O. Box 2008, MS-6367
+
+  email: harrisonrj@ornl.gov
+  tel:   865-241-3937
+  fax:   865-572-0680
+*/
+
+#include <madness/world/MADworld.h>
+#include <madness/world/world_topology.h>
+#include <cstdlib>
+
+using namespace madness;
+
+long square(long i) {
+    return i*i;
+}
+
+long wait_for(long i) {
+    return i;
+}
+
+int realmain(World& world) {
+    int nerror = 0;
+    const NodeTopology* topology = world.node_topology();
+    if (not topology) {
+        print("topology: not enabled by MAD_NODE_TOPOLOGY");
+        return 1;
+    }
+
+    // blocks of two ranks, as set in main
+    const std::vector<ProcessID>& peers = topology->peers();
+    if (topology->leader() != world.rank()/2*2 or topology->nnode() != (world.size() + 1)/2
+            or long(peers.size()) != std::min(2, world.size() - topology->leader())) {
+        print("topology: wrong node of rank", world.rank(), topology->leader(), topology->nnode());
+        ++nerror;
+    }
+
+    // the leader fills, everybody reads; private writes stay private
+    {
+        NodeSharedMemory shm(*topology, 1000, [&](unsigned char* p) {
+            for (int i = 0; i < 1000; ++i) p[i] = (unsigned char)(i + topology->leader());
+        });
+        for (int i = 0; i < 1000; ++i) {
+            if (shm.data()[i] != (unsigned char)(i + topology->leader())) {
+                print("topology: wrong byte in shared memory", world.rank(), i);
+                ++nerror;
+                break;
+            }
+        }
+        shm.data()[0] = (unsigned char)(world.rank() + 100);
+        world.gop.fence();
+        if (shm.data()[0] != (unsigned char)(world.rank() + 100)) {
+            print("topology: copy-on-write data changed by another process", world.rank());
+            ++nerror;
+        }
+    }
+
+    // shared writes are seen by all processes of the node
+    {
+        NodeSharedMemory shm(*topology, peers.size(), nullptr, true);
+        for (std::size_t i = 0; i < peers.size(); ++i) {
+            if (peers[i] == world.rank()) shm.data()[i] = 1;
+        }
+        world.gop.fence();
+        for (std::size_t i = 0; i < peers.size(); ++i) {
+            if (shm.data()[i] != 1) {
+                print("topology: shared write not seen", world.rank(), peers[i]);
+                ++nerror;
+            }
+        }
+    }
+
+    // the pending tasks of the leader are seen by its peers
+    {
+        const long ntask = 4*ThreadPool::size() + 4;
+        Future<long> gate;
+        std::vector<Future<long> > blocked;
+        if (topology->is_leader()) {
+            for (long i = 0; i < ntask; ++i) blocked.push_back(world.taskq.add(wait_for, gate));
+        }
+        world.gop.barrier();
+        if (topology->load(topology->leader()) < ntask) {
+            print("topology: load of the leader", topology->load(topology->leader()), "expected", ntask);
+            ++nerror;
+        }
+        if (topology->is_leader() and peers.size() > 1 and topology->offload_target() == world.rank()) {
+            print("topology: busy leader does not offload");
+            ++nerror;
+        }
+        if (not topology->is_leader() and topology->offload_target() != world.rank()) {
+            print("topology: idle process offloads");
+            ++nerror;
+        }
+
+        // tasks added while the leader is busy, wherever they run
+        long sum = 0;
+        std::vector<Future<long> > result;
+        for (long i = 0; i < 100; ++i) result.push_back(add_on_node(world, square, i));
+        for (long i = 0; i < 100; ++i) sum += result[i].get() - i*i;
+        if (sum != 0) {
+            print("topology: wrong results of offloaded tasks");
+            ++nerror;
+        }
+
+        gate.set(0);
+        world.gop.fence();
+        if (topology->load(world.rank()) != 0) {
+            print("topology: load after fence", topology->load(world.rank()));
+            ++nerror;
+        }
+    }
+
+    world.gop.fence();
+    return nerror;
+}
+
+int main(int argc, char** argv) {
+    setenv("MAD_NODE_TOPOLOGY", "1", 1);
+    setenv("MAD_NODE_SIZE", "2", 1);
+    World& world = initialize(argc,argv);
+    int nerror = realmain(world);
+    world.gop.sum(nerror);
+    if (world.rank() == 0) print(nerror ? "topology test FAILED" : "topology test passed");
+    finalize();
+    return nerror ? 1 : 0;
+}
@@ -0,0 +1,107 @@
+/*
+  This file is part of MADNESS.
+
+  Copyright (C) 2007,2010 Oak Ridge National Laboratory
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+
+  For more information please contact:
+
+  Robert J. Harrison
+  Oak Ridge National Laboratory
+  One Bethel Valley Road
+  P.O. Box 2008, MS-6367
+
+  email: harrisonrj@ornl.gov
+  tel:   865-241-3937
+  fax:   865-572-0680
+*/
+
+#include <madness/world/MADworld.h>
+#include <madness/world/worldtrace.h>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+using namespace madness;
+
+double work(int i) {
+    double sum = 0.0;
+    for (int j=0; j<1000; ++j) sum += 1.0/(i+j+1);
+    return sum;
+}
+
+int realmain(World& world) {
+    int nerror = 0;
+
+    tracing::Tracer::clear();
+    tracing::Tracer::enable(1024, wall_time());
+    for (int i=0; i<100; ++i) world.taskq.add(work, i);
+    {
+        tracing::Span span("user_block");
+        world.gop.fence();
+    }
+    tracing::Tracer::record_counter("test_counter", 42.0);
+    tracing::Tracer::disable();
+
+    // 100 tasks, one fence, two counters sampled at fence entry, the user span and the counter
+    const std::size_t nevent = tracing::Tracer::size();
+    if (nevent < 104) {
+        print("trace: expected at least 104 events, got", nevent);
+        ++nerror;
+    }
+
+    // events are dropped while disabled
+    world.taskq.add(work, 0);
+    world.gop.fence();
+    if (tracing::Tracer::size() != nevent) {
+        print("trace: events recorded while disabled");
+        ++nerror;
+    }
+
+    const std::string prefix = "test_trace";
+    tracing::Tracer::write_chrome_trace(world, prefix);
+    const std::string filename = prefix + "." + std::to_string(world.rank()) + ".json";
+    std::ifstream f(filename);
+    std::stringstream ss;
+    ss << f.rdbuf();
+    const std::string json = ss.str();
+    for (const char* s : {"\"traceEvents\"", "\"cat\":\"task\"", "\"cat\":\"fence\"",
+                          "\"user_block\"", "\"test_counter\"", "\"ph\":\"C\""}) {
+        if (json.find(s) == std::string::npos) {
+            print("trace: missing", s, "in", filename);
+            ++nerror;
+        }
+    }
+    std::remove(filename.c_str());
+
+    tracing::Tracer::clear();
+    if (tracing::Tracer::size() != 0) {
+        print("trace: clear did not discard events");
+        ++nerror;
+    }
+
+    world.gop.fence();
+    return nerror;
+}
+
+int main(int argc, char** argv) {
+    World& world = initialize(argc,argv);
+    int nerror = realmain(world);
+    world.gop.sum(nerror);
+    if (world.rank() == 0) print(nerror ? "trace test FAILED" : "trace test passed");
+    finalize();
+    return nerror ? 1 : 0;
+}
@@ -0,0 +1,96 @@
+/*
+  This file is part of MADNESS.
+
+  Copyright (C) 2007,2010 Oak Ridge National Laboratory
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+
+  For more information please contact:
+
+  Robert J. Harrison
+  Oak Ridge National Laboratory
+  One Bethel Valley Road
+  P.O. Box 2008, MS-6367
+
+  email: harrisonrj@ornl.gov
+  tel:   865-241-3937
+  fax:   865-572-0680
+*/
+
+#include <madness/world/MADworld.h>
+#include <madness/world/worldcounters.h>
+
+using namespace madness;
+
+void count_calls(int i) {
+    static const Counter ncall("test.calls");
+    static const CounterArray nlevel("test.level", 4);
+    ncall += 1;
+    nlevel.add(i, 1);
+}
+
+int realmain(World& world) {
+    int nerror = 0;
+    CounterRegistry::reset();
+
+    const int ntask = 1000;
+    for (int i=0; i<ntask; ++i) world.taskq.add(count_calls, i%6);
+    world.gop.fence();
+
+    // thread-local slots summed on this process
+    if (CounterRegistry::local_value("test.calls") != std::uint64_t(ntask)) {
+        print("counters: local value", CounterRegistry::local_value("test.calls"), "expected", ntask);
+        ++nerror;
+    }
+    // levels 4 and 5 end up in the last counter of the array
+    if (CounterRegistry::local_value("test.level[3]") != std::uint64_t(ntask/6*3 + 1)) {
+        print("counters: overflow bin", CounterRegistry::local_value("test.level[3]"));
+        ++nerror;
+    }
+
+    // counters known to some processes only are still summed
+    if (world.rank() == world.size()-1) {
+        static const Counter nlast("test.last_rank_only");
+        nlast += 7;
+    }
+    std::map<std::string, std::uint64_t> global = CounterRegistry::sum(world);
+    if (global["test.calls"] != std::uint64_t(ntask)*world.size()) {
+        print("counters: global value", global["test.calls"]);
+        ++nerror;
+    }
+    if (global["test.last_rank_only"] != 7) {
+        print("counters: counter of a single rank", global["test.last_rank_only"]);
+        ++nerror;
+    }
+    CounterRegistry::print(world, "test counters");
+
+    CounterRegistry::reset();
+    if (CounterRegistry::local_value("test.calls") != 0) {
+        print("counters: reset failed");
+        ++nerror;
+    }
+
+    world.gop.fence();
+    return nerror;
+}
+
+int main(int argc, char** argv) {
+    World& world = initialize(argc,argv);
+    int nerror = realmain(world);
+    world.gop.sum(nerror);
+    if (world.rank() == 0) print(nerror ? "counter test FAILED" : "counter test passed");
+    finalize();
+    return nerror ? 1 : 0;
+}
@@ -41,6 +41,7 @@
 #include <madness/world/thread_info.h>
 #include <madness/world/dqueue.h>
 #include <madness/world/function_traits.h>
+#include <madness/world/worldtrace.h>
 #include <vector>
 #include <cstddef>
 #include <cstdio>
@@ -905,6 +906,15 @@ namespace madness {
             id.second = 0ul;
         }
 
+        /// Record the span of this task in the timeline trace.
+
+        /// \param[in] start The time at which the task started running.
+        void trace_run(double start) const {
+            std::pair<void*,unsigned short> id;
+            get_id(id);
+            tracing::Tracer::record_span(tracing::EventKind::task, start, wall_time(), id.first, id.second);
+        }
+
 #ifndef HAVE_INTEL_TBB
 
         Barrier* barrier; ///< Barrier, only allocated for multithreaded tasks.
@@ -919,6 +929,7 @@ namespace madness {
             // A downside is this does not preserve any relationships between thread
             // numbering and the architecture ... more work ahead.
             int nthread = get_nthread();
+            const double trace_start = tracing::Tracer::enabled() ? wall_time() : -1.0;
             if (nthread == 1) {
 #ifdef MADNESS_TASK_PROFILING
                 task_event_->start(id_, nthread, submit_time_);
@@ -927,6 +938,7 @@ namespace madness {
 #ifdef MADNESS_TASK_PROFILING
                 task_event_->stop();
 #endif // MADNESS_TASK_PROFILING
+                if (trace_start >= 0.0) trace_run(trace_start);
                 return true;
             }
             else {
@@ -940,6 +952,7 @@ namespace madness {
 #endif // MADNESS_TASK_PROFILING
 
                 run(TaskThreadEnv(nthread, id, barrier));
+                if (id == 0 && trace_start >= 0.0) trace_run(trace_start);
 
 #ifdef MADNESS_TASK_PROFILING
                 const bool cleanup = barrier->enter(id);
@@ -41,6 +41,9 @@
 #include <madness/world/worldam.h>
 #include <madness/world/world_task_queue.h>
 #include <madness/world/worldgop.h>
+#include <madness/world/worldtrace.h>
+#include <madness/world/worldcounters.h>
+#include <madness/world/world_topology.h>
 #include <cstdlib>
 #include <sstream>
 
@@ -129,6 +132,7 @@ namespace madness {
 //        stray WorldObjects are allowed as long as they outlive madness::finalize() :(
 //        MADNESS_ASSERT_NOEXCEPT(map_ptr_to_id.size() == 0);
 //        MADNESS_ASSERT_NOEXCEPT(map_id_to_ptr.size() == 0);
+        topology.reset();   // stops publishing the load of taskq
         worlds.remove(this);
         delete &taskq;
         delete &gop;
@@ -211,6 +215,13 @@ namespace madness {
             comm.Barrier();
         }
 
+        // Timeline tracing starts right after the barrier above so that all ranks share the epoch
+        if (getenv("MAD_TRACE")) {
+            std::size_t capacity = 65536;
+            if (const char* sbuf = getenv("MAD_TRACE_BUFFER")) capacity = std::strtoul(sbuf, nullptr, 10);
+            tracing::Tracer::enable(capacity, wall_time());
+        }
+
 #ifdef HAVE_PAPI
         begin_papi_measurement();
 #endif // HAVE_PAPI
@@ -221,6 +232,11 @@ namespace madness {
 
         // mark this thread as part of MADNESS pool
         set_thread_tag(ThreadTag_MADNESS | ThreadTag_Main);
+
+        // Processes on the same node share replicated data and offload tasks to each other, see world_topology.h
+        if (getenv("MAD_NODE_TOPOLOGY"))
+            World::default_world->topology = std::make_shared<NodeTopology>(*World::default_world);
+
         madness_initialized_ = true;
         if(!quiet && comm.Get_rank() == 0)
             std::cout << "MADNESS runtime initialized with " << ThreadPool::size()
@@ -234,6 +250,12 @@ namespace madness {
         const auto rank = World::default_world->rank();
         const auto world_size = World::default_world->size();
 
+        if (getenv("MAD_PRINT_COUNTERS")) CounterRegistry::print(*World::default_world);
+        if (const char* trace_prefix = getenv("MAD_TRACE")) {
+            tracing::Tracer::disable();
+            tracing::Tracer::write_chrome_trace(*World::default_world, trace_prefix);
+        }
+
         // Destroy the default world
         delete World::default_world;
         World::default_world = nullptr;
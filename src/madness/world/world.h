@@ -57,6 +57,7 @@
 // Standard C++ header files needed by MADworld.h
 #include <iostream>
 #include <list>
+#include <memory>
 #include <utility>
 #include <cstddef>
 
@@ -82,6 +83,7 @@ namespace madness {
     class WorldTaskQueue;
     class WorldAmInterface;
     class WorldGopInterface;
+    class NodeTopology;
 
     /// Print miscellaneous stats on a World.
 
@@ -175,6 +177,7 @@ namespace madness {
         unsigned long _id; ///< Universe wide unique ID of this world.
         unsigned long obj_id; ///< Counter for generating unique IDs within this world.
         void* user_state; ///< Holds a user-defined and managed local state.
+        std::shared_ptr<NodeTopology> topology; ///< Processes sharing a node, see world_topology.h
 
         // Default copy constructor and assignment won't compile
         // (which is good) due to reference members.
@@ -271,6 +274,13 @@ namespace madness {
         /// This has the same effect as `set_user_state(0)`.
         void clear_user_state() { user_state = nullptr; }
 
+        /// Returns the grouping of the processes by compute node, see world_topology.h
+
+        /// Only the default world has one, and only if \c MAD_NODE_TOPOLOGY
+        /// was set when calling \c madness::initialize.
+        /// \return The topology, or \c nullptr.
+        NodeTopology* node_topology() const { return topology.get(); }
+
         /// Processes command line arguments.
 
         /// Mostly intended for \c World test codes, but also provides the
@@ -0,0 +1,243 @@
+/*
+  This file is part of MADNESS.
+
+  Copyright (C) 2007,2010 Oak Ridge National Laboratory
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+
+  For more information please contact:
+
+  Robert J. Harrison
+  Oak Ridge National Laboratory
+  One Bethel Valley Road
+  P.O. Box 2008, MS-6367
+
+  email: harrisonrj@ornl.gov
+  tel:   865-241-3937
+  fax:   865-572-0680
+*/
+
+#ifndef MADNESS_WORLD_WORLD_COROUTINE_H__INCLUDED
+#define MADNESS_WORLD_WORLD_COROUTINE_H__INCLUDED
+
+/**
+ \file world_coroutine.h
+ \brief C++20 coroutine tasks that \c co_await futures.
+ \ingroup taskq
+
+ A function returning \c Coroutine<T> may \c co_await any \c Future<U>.
+ If the future is not yet assigned the coroutine is suspended; once the
+ future is set, the coroutine is resumed by a thread of the pool.  The
+ coroutine frame holds the whole continuation, so a chain of dependent
+ steps needs one allocation for the frame plus one small pool task per
+ resumption, instead of one \c TaskFn (with its argument futures and
+ dependency counter) per step.
+
+ \code
+    Coroutine<double> sum_tree(World& world, Key key) {
+        Future<double> left = world.taskq.add(sum_tree(world, key.left()));
+        Future<double> right = world.taskq.add(sum_tree(world, key.right()));
+        co_return value(key) + co_await left + co_await right;
+    }
+    ...
+    Future<double> total = world.taskq.add(sum_tree(world, root));
+ \endcode
+
+ Coroutines are only started by \c WorldTaskQueue::add, which counts them
+ as pending tasks until they finish, so that \c WorldTaskQueue::fence and
+ \c WorldGopInterface::fence wait for them.  Their first step runs in the
+ pool, never inline.
+
+ Everything here requires C++20; \c MADNESS_HAS_COROUTINES is defined to 1
+ if it is available.
+*/
+
+#if __cplusplus >= 202002L && __has_include(<coroutine>)
+#include <coroutine>
+#if defined(__cpp_impl_coroutine)
+#define MADNESS_HAS_COROUTINES 1
+#endif
+#endif
+
+#ifdef MADNESS_HAS_COROUTINES
+
+#include <madness/world/future.h>
+#include <madness/world/thread.h>
+#include <typeinfo>
+#include <utility>
+
+namespace madness {
+
+    template <typename T> class Coroutine;
+
+    namespace detail {
+
+        /// Pool task that resumes a suspended coroutine
+        class CoroutineResumeTask : public PoolTaskInterface {
+            std::coroutine_handle<> handle;
+
+            void get_id(std::pair<void*,unsigned short>& id) const override {
+                PoolTaskInterface::make_id(id, *this);
+            }
+
+        public:
+            explicit CoroutineResumeTask(std::coroutine_handle<> handle) : handle(handle) {}
+
+            void run(const TaskThreadEnv&) override {
+                handle.resume();
+            }
+        };
+
+        /// Resume a coroutine in the thread pool
+        inline void resume_in_pool(std::coroutine_handle<> handle) {
+            ThreadPool::add(new CoroutineResumeTask(handle));
+        }
+
+        /// State shared by the promises of all \c Coroutine<T>
+        template <typename T>
+        struct CoroutinePromiseBase {
+            Future<T> result;                       ///< set by co_return
+            CallbackInterface* done = nullptr;      ///< notified when the coroutine is destroyed
+
+            ~CoroutinePromiseBase() {
+                if (done) done->notify();
+            }
+
+            std::suspend_always initial_suspend() noexcept {return {};}
+            std::suspend_never final_suspend() noexcept {return {};}
+
+            /// Exceptions propagate to the pool thread that resumed the coroutine, as for tasks
+            void unhandled_exception() {throw;}
+        };
+
+        template <typename T>
+        struct CoroutinePromise : public CoroutinePromiseBase<T> {
+            Coroutine<T> get_return_object();
+
+            template <typename U>
+            void return_value(U&& value) {
+                this->result.set(std::forward<U>(value));
+            }
+        };
+
+        template <>
+        struct CoroutinePromise<void> : public CoroutinePromiseBase<void> {
+            Coroutine<void> get_return_object();
+
+            void return_void() {}
+        };
+
+        /// Awaiter returned by \c co_await on a \c Future
+
+        /// Lives in the coroutine frame while the coroutine is suspended, so
+        /// registering the continuation with the future allocates nothing.
+        template <typename T>
+        class FutureAwaiter : private CallbackInterface {
+            Future<T> f;
+            std::coroutine_handle<> handle;
+
+            void notify() override {
+                resume_in_pool(handle);
+            }
+
+        public:
+            explicit FutureAwaiter(const Future<T>& f) : f(f) {}
+
+            bool await_ready() const {return f.probe();}
+
+            void await_suspend(std::coroutine_handle<> h) {
+                handle = h;
+                // may resume the coroutine on another thread before returning:
+                // nothing may be touched afterwards
+                f.register_callback(this);
+            }
+
+            T await_resume() {return f.get();}
+        };
+
+    } // namespace detail
+
+    /// Return type of a coroutine task, see world_coroutine.h
+
+    /// Move-only handle to a coroutine that has not been started yet.  Pass
+    /// it to \c WorldTaskQueue::add to run it; a coroutine that is never
+    /// added is destroyed without running.
+    /// \tparam T Type of the \c co_return value, may be \c void
+    template <typename T>
+    class Coroutine {
+    public:
+        typedef detail::CoroutinePromise<T> promise_type;
+        typedef Future<T> futureT;
+
+    private:
+        std::coroutine_handle<promise_type> handle;
+
+        friend struct detail::CoroutinePromise<T>;
+        friend class WorldTaskQueue;
+
+        explicit Coroutine(std::coroutine_handle<promise_type> handle) : handle(handle) {}
+
+        /// Start the coroutine in the pool; \c done is notified when it has finished
+        Future<T> start(CallbackInterface* done) {
+            MADNESS_ASSERT(handle);
+            Future<T> result = handle.promise().result;
+            handle.promise().done = done;
+            detail::resume_in_pool(std::exchange(handle, nullptr));
+            return result;
+        }
+
+    public:
+        Coroutine(Coroutine&& other) noexcept : handle(std::exchange(other.handle, nullptr)) {}
+
+        Coroutine& operator=(Coroutine&& other) noexcept {
+            if (this != &other) {
+                if (handle) handle.destroy();
+                handle = std::exchange(other.handle, nullptr);
+            }
+            return *this;
+        }
+
+        Coroutine(const Coroutine&) = delete;
+        Coroutine& operator=(const Coroutine&) = delete;
+
+        ~Coroutine() {
+            if (handle) handle.destroy();
+        }
+    };
+
+    namespace detail {
+
+        template <typename T>
+        Coroutine<T> CoroutinePromise<T>::get_return_object() {
+            return Coroutine<T>(std::coroutine_handle<CoroutinePromise<T>>::from_promise(*this));
+        }
+
+        inline Coroutine<void> CoroutinePromise<void>::get_return_object() {
+            return Coroutine<void>(std::coroutine_handle<CoroutinePromise<void>>::from_promise(*this));
+        }
+
+    } // namespace detail
+
+    /// Suspend the calling coroutine until \c f is assigned; yields the value of \c f
+    template <typename T>
+    detail::FutureAwaiter<T> operator co_await(const Future<T>& f) {
+        return detail::FutureAwaiter<T>(f);
+    }
+
+} // namespace madness
+
+#endif // MADNESS_HAS_COROUTINES
+
+#endif // MADNESS_WORLD_WORLD_COROUTINE_H__INCLUDED
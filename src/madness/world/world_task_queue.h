@@ -38,6 +38,7 @@
 #ifndef MADNESS_WORLD_WORLD_TASK_QUEUE_H__INCLUDED
 #define MADNESS_WORLD_WORLD_TASK_QUEUE_H__INCLUDED
 
+#include <atomic>
 #include <type_traits>
 #include <iostream>
 #include <madness/world/meta.h>
@@ -46,6 +47,7 @@
 #include <madness/world/timers.h>
 #include <madness/world/taskfn.h>
 #include <madness/world/mem_func_wrapper.h>
+#include <madness/world/world_coroutine.h>
 
 #ifdef HAVE_INTEL_TBB
 # include <tbb/parallel_reduce.h>
@@ -318,10 +320,12 @@ namespace madness {
         World& world; ///< The communication context.
         const ProcessID me; ///< This process.
         AtomicInt nregistered; ///< Count of pending tasks.
+        std::atomic<long>* published_load = nullptr; ///< Copy of \c nregistered read by other processes, see publish_load
 
         /// \todo Brief description needed.
         void notify() {
             nregistered--;
+            if (published_load) published_load->fetch_sub(1, std::memory_order_relaxed);
         }
 
         /// \todo Brief description needed.
@@ -448,6 +452,17 @@ namespace madness {
             return nregistered;
         }
 
+        /// Keep a copy of the number of pending tasks in \c counter, or stop doing so if it is null
+
+        /// Used by \c NodeTopology to let the other processes of a node see
+        /// how busy this process is.  The copy is only a hint: call this when
+        /// no tasks are being added, e.g. right after a fence.
+        /// \param[in] counter Where the copy is kept, e.g. in shared memory.
+        void publish_load(std::atomic<long>* counter) {
+            if (counter) counter->store(long(nregistered), std::memory_order_relaxed);
+            published_load = counter;
+        }
+
 
         /// Add a new local task, taking ownership of the pointer.
 
@@ -461,6 +476,7 @@ namespace madness {
         /// \param[in] t Pointer to the task.
         void add(TaskInterface* t)  {
             nregistered++;
+            if (published_load) published_load->fetch_add(1, std::memory_order_relaxed);
 
             t->set_info(&world, this);       // Stuff info
 
@@ -468,6 +484,23 @@ namespace madness {
             t->register_submit_callback();
         }
 
+#ifdef MADNESS_HAS_COROUTINES
+        /// Add a new local coroutine task, see world_coroutine.h
+
+        /// The coroutine is started in the thread pool and counts as a
+        /// pending task until it has finished, including the time it is
+        /// suspended waiting for futures.
+        /// \tparam T The return type of the coroutine.
+        /// \param[in] task The coroutine, which must not have been started.
+        /// \return A future to the result of the coroutine.
+        template <typename T>
+        Future<T> add(Coroutine<T>&& task) {
+            nregistered++;
+            if (published_load) published_load->fetch_add(1, std::memory_order_relaxed);
+            return task.start(this);
+        }
+#endif
+
         /// \todo Brief description needed.
 
         /// \todo Descriptions needed.
@@ -0,0 +1,172 @@
+/*
+  This file is part of MADNESS.
+
+  Copyright (C) 2007,2010 Oak Ridge National Laboratory
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+
+  For more information please contact:
+
+  Robert J. Harrison
+  Oak Ridge National Laboratory
+  One Bethel Valley Road
+  P.O. Box 2008, MS-6367
+
+  email: harrisonrj@ornl.gov
+  tel:   865-241-3937
+  fax:   865-572-0680
+*/
+
+/**
+ \file world_topology.cc
+ \brief Implementation of the node topology and of node-shared memory.
+ \ingroup parallel_runtime
+*/
+
+#include <madness/world/world_topology.h>
+#include <madness/world/worldgop.h>
+#include <madness/world/worldhash.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace madness {
+
+    std::vector<long> compute_node_of_rank(World& world, const char* envname) {
+        std::vector<long> node(world.size(), 0l);
+        if (const char* env = std::getenv(envname)) {
+            const long n = std::max(1l, std::atol(env));
+            for (int r = 0; r < world.size(); ++r) node[r] = r / n;
+            return node;
+        }
+        char hostname[256] = {0};
+        gethostname(hostname, sizeof(hostname) - 1);
+        std::vector<long> hosthash(world.size(), 0l);
+        hosthash[world.rank()] = long(hash_range(hostname, hostname + strlen(hostname)));
+        world.gop.sum(hosthash.data(), hosthash.size());
+        for (int r = 0; r < world.size(); ++r) {
+            node[r] = r;
+            for (int s = 0; s < r; ++s) {
+                if (hosthash[s] == hosthash[r]) {
+                    node[r] = node[s];
+                    break;
+                }
+            }
+        }
+        // number the nodes consecutively
+        std::vector<long> index(world.size(), -1l);
+        long nnode = 0;
+        for (int r = 0; r < world.size(); ++r) {
+            if (index[node[r]] < 0) index[node[r]] = nnode++;
+            node[r] = index[node[r]];
+        }
+        return node;
+    }
+
+    NodeSharedMemory::NodeSharedMemory(const NodeTopology& topology, std::size_t size,
+            const std::function<void(unsigned char*)>& fill, bool shared_writes) {
+        World& world = topology.world;
+        char name[64];
+        snprintf(name, sizeof(name), "/madness.%ld.%d.%ld", topology.job_id,
+                topology.leader(), topology.nsegment++);
+
+        if (topology.is_leader()) {
+            const int fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0600);
+            if (fd < 0) MADNESS_EXCEPTION("NodeSharedMemory: shm_open failed", errno);
+            if (ftruncate(fd, std::max(size, std::size_t(1))) != 0) {
+                close(fd);
+                shm_unlink(name);
+                MADNESS_EXCEPTION("NodeSharedMemory: cannot resize the segment", errno);
+            }
+            if (size > 0 and fill) {
+                void* p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+                if (p == MAP_FAILED) {
+                    close(fd);
+                    shm_unlink(name);
+                    MADNESS_EXCEPTION("NodeSharedMemory: mmap failed", errno);
+                }
+                fill(static_cast<unsigned char*>(p));
+                munmap(p, size);
+            }
+            close(fd);
+        }
+        world.gop.fence();
+
+        // everybody, including the leader, maps the finished segment
+        const int fd = shm_open(name, O_RDWR, 0600);
+        if (fd < 0) MADNESS_EXCEPTION("NodeSharedMemory: cannot open the segment of the node leader", errno);
+        struct stat st;
+        fstat(fd, &st);
+        bytes = std::size_t(st.st_size);
+        void* p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE,
+                shared_writes ? MAP_SHARED : MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (p == MAP_FAILED) MADNESS_EXCEPTION("NodeSharedMemory: mmap failed", errno);
+        ptr = static_cast<unsigned char*>(p);
+        world.gop.fence();
+        if (topology.is_leader()) shm_unlink(name);
+    }
+
+    NodeSharedMemory::~NodeSharedMemory() {
+        if (ptr) munmap(ptr, bytes);
+    }
+
+    NodeTopology::NodeTopology(World& world, const char* envname)
+        : world(world), node_of_rank(compute_node_of_rank(world, envname)), job_id(0) {
+        for (ProcessID r = 0; r < world.size(); ++r) {
+            if (node_of_rank[r] == node_of_rank[world.rank()]) node_peers.push_back(r);
+        }
+        if (world.rank() == 0) job_id = long(getpid());
+        world.gop.broadcast(job_id, 0);
+
+        const std::size_t npeer = node_peers.size();
+        loads.reset(new NodeSharedMemory(*this, npeer*sizeof(std::atomic<long>), [npeer](unsigned char* p) {
+            for (std::size_t i = 0; i < npeer; ++i) new (p + i*sizeof(std::atomic<long>)) std::atomic<long>(0);
+        }, true));
+        world.taskq.publish_load(load_of_peer(peer_index(world.rank())));
+    }
+
+    NodeTopology::~NodeTopology() {
+        world.taskq.publish_load(nullptr);
+    }
+
+    long NodeTopology::load(ProcessID rank) const {
+        MADNESS_ASSERT(same_node(rank, world.rank()));
+        return load_of_peer(peer_index(rank))->load(std::memory_order_relaxed);
+    }
+
+    ProcessID NodeTopology::offload_target() const {
+        const long nthread = std::max(1l, long(ThreadPool::size()));
+        if (load(world.rank()) <= nthread) return world.rank();
+        ProcessID target = world.rank();
+        long least = nthread;
+        for (ProcessID p : node_peers) {
+            const long l = load(p);
+            if (l < least) {
+                least = l;
+                target = p;
+            }
+        }
+        return target;
+    }
+
+} // namespace madness
@@ -0,0 +1,188 @@
+/*
+  This file is part of MADNESS.
+
+  Copyright (C) 2007,2010 Oak Ridge National Laboratory
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+
+  For more information please contact:
+
+  Robert J. Harrison
+  Oak Ridge National Laboratory
+  One Bethel Valley Road
+  P.O. Box 2008, MS-6367
+
+  email: harrisonrj@ornl.gov
+  tel:   865-241-3937
+  fax:   865-572-0680
+*/
+
+#ifndef MADNESS_WORLD_WORLD_TOPOLOGY_H__INCLUDED
+#define MADNESS_WORLD_WORLD_TOPOLOGY_H__INCLUDED
+
+/**
+ \file world_topology.h
+ \brief Groups the processes of the default world by compute node.
+ \ingroup parallel_runtime
+
+ With one process per socket or per core, processes on the same node hold
+ identical copies of replicated data and cannot help each other when their
+ task queues run dry.  If the environment variable \c MAD_NODE_TOPOLOGY is
+ set before calling \c madness::initialize, the default world gets a
+ \c NodeTopology (see \c World::node_topology) and
+
+  - \c FunctionImpl::replicate keeps one copy of the coefficients per node
+    in POSIX shared memory, mapped copy-on-write by all processes of the
+    node (see \c NodeSharedMemory);
+  - each process publishes the number of its pending tasks in a segment
+    shared by the node, and \c add_on_node sends a task to an idle process
+    of the same node if this process is busy.
+
+ Processes are grouped by host name, or in blocks of \c n consecutive ranks
+ if \c MAD_NODE_SIZE=n is set, which allows testing several "nodes" on one
+ host.  Without \c MAD_NODE_TOPOLOGY nothing changes.
+*/
+
+#include <madness/world/world.h>
+#include <madness/world/world_task_queue.h>
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace madness {
+
+    /// Node index of every rank of \c world, from the host name or the environment variable \c envname
+
+    /// If \c envname is set to \c n, blocks of \c n consecutive ranks form a
+    /// node.  Collective on \c world.
+    std::vector<long> compute_node_of_rank(World& world, const char* envname);
+
+    class NodeTopology;
+
+    /// A block of POSIX shared memory filled by one process of each node and mapped by all of them
+
+    /// The leader of each node creates the segment and fills it; the other
+    /// processes of the node map it once the leader is done.  The name of the
+    /// segment is removed right away, so the memory is released by the system
+    /// once the last process has destroyed its \c NodeSharedMemory (or has
+    /// exited), and the destructor is not collective.
+    ///
+    /// With \c shared_writes the mapping is shared, i.e. writes are seen by
+    /// all processes of the node.  Otherwise it is private copy-on-write:
+    /// pages are shared as long as nobody writes to them, and a process that
+    /// writes gets its own copy of the page, as if it had a copy of the data.
+    class NodeSharedMemory {
+        unsigned char* ptr = nullptr;
+        std::size_t bytes = 0;
+
+        NodeSharedMemory(const NodeSharedMemory&) = delete;
+        NodeSharedMemory& operator=(const NodeSharedMemory&) = delete;
+
+    public:
+        /// Collective on the world of \c topology, fences twice
+
+        /// @param[in] topology     the processes of the node
+        /// @param[in] size         size of the segment, only used on the leader of the node
+        /// @param[in] fill         called by the leader with the (zeroed) segment before the others map it
+        /// @param[in] shared_writes    writes are seen by all processes of the node
+        NodeSharedMemory(const NodeTopology& topology, std::size_t size,
+                const std::function<void(unsigned char*)>& fill, bool shared_writes=false);
+
+        ~NodeSharedMemory();
+
+        unsigned char* data() const {return ptr;}
+
+        std::size_t size() const {return bytes;}
+    };
+
+    /// The processes of the default world that share a compute node, see world_topology.h
+    class NodeTopology {
+        World& world;
+        std::vector<long> node_of_rank;     ///< node index of each rank
+        std::vector<ProcessID> node_peers;  ///< ranks on the node of this process, in increasing order
+        long job_id;                        ///< pid of rank 0, makes segment names unique on a host
+        mutable long nsegment = 0;          ///< segments made so far, the same on all processes
+        std::unique_ptr<NodeSharedMemory> loads;   ///< pending tasks of each peer
+
+        friend class NodeSharedMemory;
+
+        NodeTopology(const NodeTopology&) = delete;
+        NodeTopology& operator=(const NodeTopology&) = delete;
+
+        std::size_t peer_index(ProcessID rank) const {
+            return std::lower_bound(node_peers.begin(), node_peers.end(), rank) - node_peers.begin();
+        }
+
+        std::atomic<long>* load_of_peer(std::size_t i) const {
+            return reinterpret_cast<std::atomic<long>*>(loads->data()) + i;
+        }
+
+    public:
+        /// Collective on \c world
+        /// @param[in] world    the world, normally the default world
+        /// @param[in] envname  environment variable to group ranks into blocks, see compute_node_of_rank
+        explicit NodeTopology(World& world, const char* envname="MAD_NODE_SIZE");
+
+        ~NodeTopology();
+
+        World& get_world() const {return world;}
+
+        /// node index of \c rank
+        long node(ProcessID rank) const {return node_of_rank[rank];}
+
+        /// number of nodes
+        long nnode() const {return *std::max_element(node_of_rank.begin(), node_of_rank.end()) + 1;}
+
+        bool same_node(ProcessID a, ProcessID b) const {return node_of_rank[a] == node_of_rank[b];}
+
+        /// ranks on the node of this process, in increasing order
+        const std::vector<ProcessID>& peers() const {return node_peers;}
+
+        /// lowest rank on the node of this process
+        ProcessID leader() const {return node_peers.front();}
+
+        bool is_leader() const {return leader() == world.rank();}
+
+        /// pending tasks of \c rank as last published, \c rank must be on this node
+        long load(ProcessID rank) const;
+
+        /// the process of this node to which a new task should go
+
+        /// This process, unless it has more pending tasks than threads and
+        /// another process of the node has fewer pending tasks than threads,
+        /// in which case the least loaded of those is returned.
+        ProcessID offload_target() const;
+    };
+
+    /// Add a task on this process or, if it is busy, on an idle process of the same node
+
+    /// Same as \c world.taskq.add(fn, args...) without a \c NodeTopology.
+    /// Otherwise the destination is \c NodeTopology::offload_target, and the
+    /// task must be one that can be sent to another process: \c fn is a free
+    /// function and the arguments are serializable values or assigned futures.
+    template <typename fnT, typename... argsT>
+    typename detail::function_enabler<fnT>::type
+    add_on_node(World& world, fnT fn, const argsT&... args) {
+        const NodeTopology* topology = world.node_topology();
+        const ProcessID dest = topology ? topology->offload_target() : world.rank();
+        return world.taskq.add(dest, fn, args...);
+    }
+
+} // namespace madness
+
+#endif // MADNESS_WORLD_WORLD_TOPOLOGY_H__INCLUDED
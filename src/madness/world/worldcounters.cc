@@ -0,0 +1,168 @@
+/*
+  This file is part of MADNESS.
+
+  Copyright (C) 2007,2010 Oak Ridge National Laboratory
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+
+  For more information please contact:
+
+  Robert J. Harrison
+  Oak Ridge National Laboratory
+  One Bethel Valley Road
+  P.O. Box 2008, MS-6367
+
+  email: harrisonrj@ornl.gov
+  tel:   865-241-3937
+  fax:   865-572-0680
+*/
+
+/**
+ \file worldcounters.cc
+ \brief Implementation of the event counter registry.
+ \ingroup parallel_runtime
+*/
+
+#include <madness/world/worldcounters.h>
+#include <madness/world/MADworld.h>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace madness {
+
+    namespace {
+
+        std::mutex registry_mutex;
+        std::vector<std::string> counter_names;          // indexed by id
+        std::map<std::string, std::size_t> counter_ids;  // name -> id
+        // blocks are never freed so that counts of threads that have exited are kept
+        std::vector<std::unique_ptr<detail::CounterBlock>> counter_blocks;
+
+        /// Register a counter, the caller holds the lock
+        std::size_t register_name(const std::string& name) {
+            auto it = counter_ids.find(name);
+            if (it != counter_ids.end()) return it->second;
+            if (counter_names.size() >= CounterRegistry::max_counters)
+                MADNESS_EXCEPTION("CounterRegistry: too many counters", counter_names.size());
+            const std::size_t id = counter_names.size();
+            counter_names.push_back(name);
+            counter_ids[name] = id;
+            return id;
+        }
+
+        std::uint64_t value_of(std::size_t id) {
+            std::uint64_t sum = 0;
+            for (const auto& b : counter_blocks) sum += b->value[id].load(std::memory_order_relaxed);
+            return sum;
+        }
+
+    } // anonymous namespace
+
+    namespace detail {
+
+        CounterBlock* register_counter_block() {
+            std::unique_ptr<CounterBlock> block(new CounterBlock);
+            for (auto& v : block->value) v.store(0, std::memory_order_relaxed);
+            std::lock_guard<std::mutex> lock(registry_mutex);
+            counter_blocks.push_back(std::move(block));
+            return counter_blocks.back().get();
+        }
+
+    } // namespace detail
+
+    std::size_t CounterRegistry::id(const std::string& name) {
+        std::lock_guard<std::mutex> lock(registry_mutex);
+        return register_name(name);
+    }
+
+    CounterArray::CounterArray(const std::string& name, std::size_t n) : n_(std::max(n, std::size_t(1))) {
+        // pad the index so that the members sort numerically by name
+        const std::size_t width = std::to_string(n_-1).size();
+        auto member = [&](std::size_t i) {
+            std::string index = std::to_string(i);
+            return name + "[" + std::string(width - index.size(), '0') + index + "]";
+        };
+        std::lock_guard<std::mutex> lock(registry_mutex);
+        id0_ = register_name(member(0));
+        for (std::size_t i = 1; i < n_; ++i) {
+            const std::size_t id = register_name(member(i));
+            MADNESS_CHECK(id == id0_ + i);  // members of an array must be registered together
+        }
+    }
+
+    std::uint64_t CounterRegistry::local_value(const std::string& name) {
+        std::lock_guard<std::mutex> lock(registry_mutex);
+        auto it = counter_ids.find(name);
+        return (it == counter_ids.end()) ? 0 : value_of(it->second);
+    }
+
+    std::map<std::string, std::uint64_t> CounterRegistry::local_values() {
+        std::lock_guard<std::mutex> lock(registry_mutex);
+        std::map<std::string, std::uint64_t> result;
+        for (std::size_t id = 0; id < counter_names.size(); ++id) result[counter_names[id]] = value_of(id);
+        return result;
+    }
+
+    std::map<std::string, std::uint64_t> CounterRegistry::sum(World& world) {
+        const std::map<std::string, std::uint64_t> local = local_values();
+        std::vector<std::string> names;
+        for (const auto& kv : local) names.push_back(kv.first);
+
+        // the common case is that all processes know the same counters
+        std::vector<std::string> all_names = names;
+        world.gop.broadcast_serializable(all_names, 0);
+        int mismatch = (all_names != names);
+        world.gop.max(mismatch);
+        if (mismatch) {
+            all_names = world.gop.concat0(names);
+            std::sort(all_names.begin(), all_names.end());
+            all_names.erase(std::unique(all_names.begin(), all_names.end()), all_names.end());
+            world.gop.broadcast_serializable(all_names, 0);
+        }
+
+        std::vector<std::uint64_t> values(all_names.size(), 0);
+        for (std::size_t i = 0; i < all_names.size(); ++i) {
+            auto it = local.find(all_names[i]);
+            if (it != local.end()) values[i] = it->second;
+        }
+        if (!values.empty()) world.gop.sum(values.data(), values.size());
+
+        std::map<std::string, std::uint64_t> result;
+        for (std::size_t i = 0; i < all_names.size(); ++i) result[all_names[i]] = values[i];
+        return result;
+    }
+
+    void CounterRegistry::print(World& world, const std::string& title) {
+        const std::map<std::string, std::uint64_t> values = sum(world);
+        if (world.rank() != 0) return;
+        std::size_t width = 8;
+        for (const auto& kv : values) width = std::max(width, kv.first.size());
+        printf("\n%s\n", title.c_str());
+        for (const auto& kv : values) {
+            if (kv.second == 0) continue;
+            printf("  %-*s %20llu\n", int(width), kv.first.c_str(), (unsigned long long)kv.second);
+        }
+        printf("\n");
+    }
+
+    void CounterRegistry::reset() {
+        std::lock_guard<std::mutex> lock(registry_mutex);
+        for (const auto& b : counter_blocks)
+            for (auto& v : b->value) v.store(0, std::memory_order_relaxed);
+    }
+
+} // namespace madness
@@ -0,0 +1,169 @@
+/*
+  This file is part of MADNESS.
+
+  Copyright (C) 2007,2010 Oak Ridge National Laboratory
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+
+  For more information please contact:
+
+  Robert J. Harrison
+  Oak Ridge National Laboratory
+  One Bethel Valley Road
+  P.O. Box 2008, MS-6367
+
+  email: harrisonrj@ornl.gov
+  tel:   865-241-3937
+  fax:   865-572-0680
+*/
+
+#ifndef MADNESS_WORLD_WORLDCOUNTERS_H__INCLUDED
+#define MADNESS_WORLD_WORLDCOUNTERS_H__INCLUDED
+
+/**
+ \file worldcounters.h
+ \brief Always-compiled event counters for hot paths.
+ \ingroup parallel_runtime
+
+ A counter is identified by a name and registered once (typically as a
+ function-local static \c Counter).  Each thread increments its own slot
+ with a relaxed load/store, so the cost on the hot path is a thread-local
+ pointer dereference and an add; no atomics read-modify-write and no locks
+ are involved.  Values are summed over threads on demand, and over
+ processes with \c CounterRegistry::sum, which matches counters by name.
+
+ \code
+    static const Counter ncall("mymodule.calls");
+    ncall += 1;
+    ...
+    CounterRegistry::print(world);   // collective, table on rank 0
+ \endcode
+
+ Setting the environment variable \c MAD_PRINT_COUNTERS prints all
+ counters at \c madness::finalize.
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+
+namespace madness {
+
+    class World;
+
+    namespace detail {
+
+        /// Counter slots of one thread
+        struct CounterBlock;
+
+        /// Allocate and register the counter block of the calling thread
+        CounterBlock* register_counter_block();
+
+        inline CounterBlock*& counter_block_accessor() {
+            thread_local CounterBlock* value = nullptr;
+            return value;
+        }
+
+    } // namespace detail
+
+    /// Process-wide registry of named event counters
+    class CounterRegistry {
+    public:
+        /// Maximum number of distinct counters
+        static constexpr std::size_t max_counters = 512;
+
+        /// Return the id of the counter with the given name, registering it if needed
+        static std::size_t id(const std::string& name);
+
+        /// Add \c n to counter \c id for the calling thread
+        static void add(std::size_t id, std::uint64_t n);
+
+        /// Value of the counter with the given name summed over the threads of this process
+
+        /// Returns zero for unknown names.
+        static std::uint64_t local_value(const std::string& name);
+
+        /// All counters of this process summed over threads, keyed by name
+        static std::map<std::string, std::uint64_t> local_values();
+
+        /// All counters summed over threads and processes, keyed by name
+
+        /// Collective on \c world.  Counters registered on only some of
+        /// the processes are included.
+        static std::map<std::string, std::uint64_t> sum(World& world);
+
+        /// Print all counters (summed over processes) as a table on rank 0
+
+        /// Collective on \c world.  Counters that are zero everywhere are omitted.
+        static void print(World& world, const std::string& title="counters");
+
+        /// Set all counters to zero
+
+        /// Must only be called when no other thread is counting, e.g. after a fence.
+        static void reset();
+    };
+
+    namespace detail {
+
+        struct CounterBlock {
+            std::atomic<std::uint64_t> value[CounterRegistry::max_counters];
+        };
+
+    } // namespace detail
+
+    inline void CounterRegistry::add(std::size_t id, std::uint64_t n) {
+        detail::CounterBlock*& block = detail::counter_block_accessor();
+        if (!block) block = detail::register_counter_block();
+        // single writer per slot: no read-modify-write atomic needed
+        std::atomic<std::uint64_t>& v = block->value[id];
+        v.store(v.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+    /// Handle to a named counter; intended to be used as a (function-local) static
+    class Counter {
+        std::size_t id_;
+    public:
+        explicit Counter(const std::string& name) : id_(CounterRegistry::id(name)) {}
+
+        const Counter& operator+=(std::uint64_t n) const {
+            CounterRegistry::add(id_, n);
+            return *this;
+        }
+
+        std::size_t id() const {return id_;}
+    };
+
+    /// A family of counters <tt>name[0]</tt>, ..., <tt>name[n-1]</tt>, e.g. one per tree level
+
+    /// Indices beyond the end are accumulated in the last counter.  The
+    /// index in the name is zero-padded, e.g. <tt>name[07]</tt> for n>10.
+    class CounterArray {
+        std::size_t id0_, n_;
+    public:
+        CounterArray(const std::string& name, std::size_t n);
+
+        void add(std::size_t i, std::uint64_t value) const {
+            CounterRegistry::add(id0_ + std::min(i, n_-1), value);
+        }
+
+        std::size_t size() const {return n_;}
+    };
+
+} // namespace madness
+
+#endif // MADNESS_WORLD_WORLDCOUNTERS_H__INCLUDED
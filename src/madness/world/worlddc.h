@@ -442,14 +442,19 @@ namespace madness {
             return pmap;
         }
 
+        /// switches to a ProcessMap where all nodes are local, keeping the local data
+        void make_pmap_local() {
+        	pmap->deregister_callback(this);
+        	pmap.reset(new WorldDCLocalPmap<keyT>(this->get_world()));
+        	pmap->register_callback(this);
+        }
+
         /// replicates this WorldContainer on all ProcessIDs and generates a
         /// ProcessMap where all nodes are local
         void replicate(bool fence) {
 
         	World& world=this->get_world();
-        	pmap->deregister_callback(this);
-        	pmap.reset(new WorldDCLocalPmap<keyT>(world));
-        	pmap->register_callback(this);
+        	make_pmap_local();
 
         	for (ProcessID rank=0; rank<world.size(); rank++) {
         		if (rank == world.rank()) {
@@ -849,6 +854,15 @@ namespace madness {
         	p->replicate(fence);
         }
 
+        /// switches to a ProcessMap where all nodes are local, keeping the local data
+
+        /// The caller inserts the nodes of the other processes, see
+        /// FunctionImpl::replicate.  No communication.
+        void make_pmap_local() {
+            check_initialized();
+            p->make_pmap_local();
+        }
+
         /// Inserts/replaces key+value pair (non-blocking communication if key not local)
         void replace(const pairT& datum) {
             check_initialized();
@@ -32,6 +32,7 @@
 #include <limits>
 #include <madness/world/worldgop.h>
 #include <madness/world/MADworld.h>
+#include <madness/world/worldtrace.h>
 #ifdef MADNESS_HAS_GOOGLE_PERF_TCMALLOC
 #include <gperftools/malloc_extension.h>
 #endif
@@ -61,6 +62,11 @@ namespace madness {
         int npass = 0;
 
         //double start = wall_time();
+        const double trace_start = tracing::Tracer::enabled() ? wall_time() : -1.0;
+        if (trace_start >= 0.0) {
+            tracing::Tracer::record_counter("taskq_size", double(world_.taskq.size()));
+            tracing::Tracer::record_counter("pool_queue_size", double(ThreadPool::queue_size()));
+        }
 
       if (debug)
         madness::print(world_.rank(), ": WORLD.GOP.FENCE: entering fence loop, gfence_tag=", gfence_tag, " bcast_tag=", bcast_tag);
@@ -154,6 +160,8 @@ namespace madness {
         MallocExtension::instance()->ReleaseFreeMemory();
 //        print("clearing memory");
 #endif
+      if (trace_start >= 0.0)
+        tracing::Tracer::record_span(tracing::EventKind::fence, trace_start, wall_time(), "fence");
       if (debug)
         madness::print(world_.rank(), ": WORLD.GOP.FENCE: done with fence in ", npass, (npass > 1 ? " loops" : " loop"));
     }
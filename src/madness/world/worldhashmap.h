@@ -46,6 +46,7 @@
 #include <madness/world/worldmutex.h>
 #include <madness/world/madness_exception.h>
 #include <madness/world/worldhash.h>
+#include <madness/world/worldcounters.h>
 #include <new>
 #include <stdio.h>
 #include <map>
@@ -75,6 +76,12 @@ namespace madness {
                     : datum(datum), next(next) {}
         };
 
+        /// Counts the failed attempts to lock an entry, i.e. the lock waits of accessors
+        inline const Counter& lock_wait_counter() {
+            static const Counter nwait("hashmap.entry_lock_waits");
+            return nwait;
+        }
+
         template <class keyT, class valueT>
         class bin : private madness::Spinlock {
         private:
@@ -119,7 +126,10 @@ namespace madness {
                         gotlock = true;
                     }
                     unlock();           // END CRITICAL SECTION
-                    if (!gotlock) waiter.wait(); //cpu_relax();
+                    if (!gotlock) {
+                        lock_wait_counter() += 1;
+                        waiter.wait(); //cpu_relax();
+                    }
                 }
                 while (!gotlock);
 
@@ -141,7 +151,10 @@ namespace madness {
                     }
                     gotlock = result->try_lock(lockmode);
                     unlock();           // END CRITICAL SECTION
-                    if (!gotlock) waiter.wait(); //cpu_relax();
+                    if (!gotlock) {
+                        lock_wait_counter() += 1;
+                        waiter.wait(); //cpu_relax();
+                    }
                 }
                 while (!gotlock);
 
@@ -34,6 +34,7 @@
 #include <madness/world/worldrmi.h>
 #include <madness/world/posixmem.h>
 #include <madness/world/timers.h>
+#include <madness/world/worldtrace.h>
 #include <iostream>
 #include <algorithm>
 #include <utility>
@@ -109,7 +110,11 @@ namespace madness {
                                   " count=", count, "\n");
 
                     if (is_ordered(attr)) ++(recv_counters[src]);
+                    const double trace_start = tracing::Tracer::enabled() ? wall_time() : -1.0;
                     func(recv_buf[i], len);
+                    if (trace_start >= 0.0)
+                        tracing::Tracer::record_span(tracing::EventKind::am, trace_start, wall_time(),
+                                                   (const void*)func, tracing::id_function);
                     post_recv_buf(i);
                 }
                 else {
@@ -148,7 +153,11 @@ namespace madness {
                                 " count=", q[m].count, "\n");
 
                   ++(recv_counters[src]);
+                  const double trace_start = tracing::Tracer::enabled() ? wall_time() : -1.0;
                   q[m].func(recv_buf[q[m].i], q[m].len);
+                  if (trace_start >= 0.0)
+                      tracing::Tracer::record_span(tracing::EventKind::am, trace_start, wall_time(),
+                                                 (const void*)q[m].func, tracing::id_function);
                   post_recv_buf(q[m].i);
                 }
                 else {
@@ -516,6 +525,8 @@ namespace madness {
 
         ++(RMI::stats.nmsg_sent);
         RMI::stats.nbyte_sent += nbyte;
+        if (tracing::Tracer::enabled())
+            tracing::Tracer::record_counter("rmi_bytes_sent", double(RMI::stats.nbyte_sent));
 
 
         numsent++;
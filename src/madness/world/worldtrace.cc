@@ -0,0 +1,277 @@
+/*
+  This file is part of MADNESS.
+
+  Copyright (C) 2007,2010 Oak Ridge National Laboratory
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+
+  For more information please contact:
+
+  Robert J. Harrison
+  Oak Ridge National Laboratory
+  One Bethel Valley Road
+  P.O. Box 2008, MS-6367
+
+  email: harrisonrj@ornl.gov
+  tel:   865-241-3937
+  fax:   865-572-0680
+*/
+
+/**
+ \file worldtrace.cc
+ \brief Implementation of the timeline tracer and its Chrome trace export.
+ \ingroup parallel_runtime
+*/
+
+#include <madness/world/worldtrace.h>
+#include <madness/world/MADworld.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+#if __has_include(<execinfo.h>)
+#include <execinfo.h> // for backtrace_symbols
+#define MADNESS_TRACE_HAVE_EXECINFO 1
+#endif
+#if __has_include(<cxxabi.h>)
+#include <cxxabi.h> // for abi::__cxa_demangle
+#define MADNESS_TRACE_HAVE_CXXABI 1
+#endif
+
+namespace madness {
+    namespace tracing {
+
+        namespace {
+
+            /// Ring buffer owned by one thread
+
+            /// Only the owning thread writes; \c head is published with
+            /// release semantics so that an exporting thread sees complete
+            /// events once the application is quiescent.
+            struct EventBuffer {
+                std::unique_ptr<Event[]> events;
+                const std::size_t capacity;
+                std::atomic<std::size_t> head;
+                const int tid;
+
+                EventBuffer(std::size_t capacity, int tid)
+                    : events(new Event[capacity]), capacity(capacity), head(0), tid(tid) {}
+
+                void push(const Event& e) {
+                    const std::size_t h = head.load(std::memory_order_relaxed);
+                    events[h % capacity] = e;
+                    head.store(h + 1, std::memory_order_release);
+                }
+
+                std::size_t size() const {
+                    return std::min(head.load(std::memory_order_acquire), capacity);
+                }
+            };
+
+            std::mutex registry_mutex;
+            std::vector<std::unique_ptr<EventBuffer>> registry;
+            std::size_t buffer_capacity = 65536;
+            double trace_epoch = 0.0;
+
+            thread_local EventBuffer* local_buffer = nullptr;
+
+            EventBuffer& get_local_buffer() {
+                if (!local_buffer) {
+                    std::lock_guard<std::mutex> lock(registry_mutex);
+                    registry.emplace_back(new EventBuffer(buffer_capacity, int(registry.size())));
+                    local_buffer = registry.back().get();
+                }
+                return *local_buffer;
+            }
+
+            const char* kind_name(EventKind kind) {
+                switch (kind) {
+                    case EventKind::task:      return "task";
+                    case EventKind::am:        return "am";
+                    case EventKind::fence:     return "fence";
+                    case EventKind::macrotask: return "macrotask";
+                    case EventKind::user:      return "user";
+                    case EventKind::counter:   return "counter";
+                }
+                return "unknown";
+            }
+
+            std::string demangle(const char* symbol) {
+#ifdef MADNESS_TRACE_HAVE_CXXABI
+                int status = 0;
+                char* name = abi::__cxa_demangle(symbol, 0, 0, &status);
+                if (status == 0 && name) {
+                    std::string result(name);
+                    free(name);
+                    return result;
+                }
+#endif
+                return std::string(symbol);
+            }
+
+            /// Resolve a function pointer to its (demangled) name, cf. profiling::TaskEvent::get_name
+            std::string function_name(const void* ptr) {
+                std::string mangled_name;
+#ifdef MADNESS_TRACE_HAVE_EXECINFO
+                void* const func_ptr[1] = {const_cast<void*>(ptr)};
+                char** bt_sym = backtrace_symbols(func_ptr, 1);
+                if (bt_sym) {
+#ifdef ON_A_MAC
+                    std::istringstream iss(bt_sym[0]);
+                    long frame;
+                    std::string file, address;
+                    iss >> frame >> file >> address >> mangled_name;
+#else
+                    const char* first = strchr(bt_sym[0], '(');
+                    if (first) {
+                        ++first;
+                        const char* last = strrchr(first, '+');
+                        if (last) mangled_name.assign(first, last - first);
+                    }
+#endif
+                    free(bt_sym);
+                }
+#endif
+                if (!mangled_name.empty()) return demangle(mangled_name.c_str());
+                std::ostringstream ss;
+                ss << ptr;
+                return ss.str();
+            }
+
+            std::string event_name(const Event& e) {
+                if (!e.id) return kind_name(e.kind);
+                switch (e.idkind) {
+                    case id_string:   return std::string(static_cast<const char*>(e.id));
+                    case id_function: return function_name(e.id);
+                    case id_typename: return demangle(static_cast<const char*>(e.id));
+                }
+                return kind_name(e.kind);
+            }
+
+            /// Quote a string for JSON output
+            std::string json_string(const std::string& s) {
+                std::string result = "\"";
+                for (const char c : s) {
+                    switch (c) {
+                        case '"':  result += "\\\""; break;
+                        case '\\': result += "\\\\"; break;
+                        case '\n': result += "\\n"; break;
+                        case '\t': result += "\\t"; break;
+                        default:
+                            if (static_cast<unsigned char>(c) < 0x20) {
+                                char buf[8];
+                                snprintf(buf, sizeof(buf), "\\u%04x", int(c));
+                                result += buf;
+                            }
+                            else result += c;
+                    }
+                }
+                return result + "\"";
+            }
+
+        } // anonymous namespace
+
+        std::atomic<bool> Tracer::enabled_{false};
+
+        void Tracer::enable(std::size_t capacity, double epoch) {
+            {
+                std::lock_guard<std::mutex> lock(registry_mutex);
+                buffer_capacity = std::max(capacity, std::size_t(1));
+                trace_epoch = epoch;
+            }
+            enabled_.store(true, std::memory_order_release);
+        }
+
+        void Tracer::disable() {
+            enabled_.store(false, std::memory_order_release);
+        }
+
+        void Tracer::clear() {
+            std::lock_guard<std::mutex> lock(registry_mutex);
+            for (auto& b : registry) b->head.store(0, std::memory_order_release);
+        }
+
+        std::size_t Tracer::size() {
+            std::lock_guard<std::mutex> lock(registry_mutex);
+            std::size_t n = 0;
+            for (const auto& b : registry) n += b->size();
+            return n;
+        }
+
+        void Tracer::record_span(EventKind kind, double start, double stop,
+                                 const void* id, unsigned short idkind) {
+            if (!enabled()) return;
+            get_local_buffer().push(Event{start, stop - start, id, idkind, kind});
+        }
+
+        void Tracer::record_counter(const char* name, double value) {
+            if (!enabled()) return;
+            get_local_buffer().push(Event{wall_time(), value, name, id_string, EventKind::counter});
+        }
+
+        void Tracer::write_chrome_trace(World& world, const std::string& prefix) {
+            world.gop.fence();
+            write_chrome_trace(prefix + "." + std::to_string(world.rank()) + ".json", world.rank());
+            world.gop.fence();
+        }
+
+        void Tracer::write_chrome_trace(const std::string& filename, int rank) {
+            std::ofstream f(filename);
+            if (!f) MADNESS_EXCEPTION("Tracer: failed to open trace file", 0);
+            f.precision(3);
+            f << std::fixed;
+
+            std::lock_guard<std::mutex> lock(registry_mutex);
+            std::map<std::pair<const void*,unsigned short>, std::string> names;
+
+            f << "{\"traceEvents\":[\n";
+            f << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << rank
+              << ",\"args\":{\"name\":\"rank " << rank << "\"}}";
+            f << ",\n{\"name\":\"process_sort_index\",\"ph\":\"M\",\"pid\":" << rank
+              << ",\"args\":{\"sort_index\":" << rank << "}}";
+            for (const auto& b : registry) {
+                f << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << rank << ",\"tid\":" << b->tid
+                  << ",\"args\":{\"name\":\"thread " << b->tid << "\"}}";
+
+                const std::size_t head = b->head.load(std::memory_order_acquire);
+                const std::size_t n = std::min(head, b->capacity);
+                for (std::size_t i = head - n; i < head; ++i) {
+                    const Event& e = b->events[i % b->capacity];
+                    auto it = names.find({e.id, e.idkind});
+                    if (it == names.end()) it = names.emplace(std::make_pair(e.id, e.idkind), json_string(event_name(e))).first;
+                    const double ts = (e.start - trace_epoch) * 1e6;
+
+                    f << ",\n{\"name\":" << it->second << ",\"cat\":\"" << kind_name(e.kind) << "\"";
+                    if (e.kind == EventKind::counter) {
+                        f << ",\"ph\":\"C\",\"ts\":" << ts << ",\"pid\":" << rank << ",\"tid\":" << b->tid
+                          << ",\"args\":{\"value\":" << e.value << "}}";
+                    }
+                    else {
+                        f << ",\"ph\":\"X\",\"ts\":" << ts << ",\"dur\":" << e.value * 1e6
+                          << ",\"pid\":" << rank << ",\"tid\":" << b->tid << "}";
+                    }
+                }
+            }
+            f << "\n],\"displayTimeUnit\":\"ms\"}\n";
+        }
+
+    } // namespace tracing
+} // namespace madness
@@ -0,0 +1,178 @@
+/*
+  This file is part of MADNESS.
+
+  Copyright (C) 2007,2010 Oak Ridge National Laboratory
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+
+  For more information please contact:
+
+  Robert J. Harrison
+  Oak Ridge National Laboratory
+  One Bethel Valley Road
+  P.O. Box 2008, MS-6367
+
+  email: harrisonrj@ornl.gov
+  tel:   865-241-3937
+  fax:   865-572-0680
+*/
+
+#ifndef MADNESS_WORLD_WORLDTRACE_H__INCLUDED
+#define MADNESS_WORLD_WORLDTRACE_H__INCLUDED
+
+/**
+ \file worldtrace.h
+ \brief Low-overhead timeline tracing of tasks, active messages, fences and macrotasks.
+ \ingroup parallel_runtime
+
+ Every thread appends fixed-size events to its own ring buffer; no locks are
+ taken on the recording path once a thread has registered its buffer.  When
+ a buffer is full the oldest events are overwritten.  At the end of a run
+ (or whenever \c Tracer::write_chrome_trace is called) each rank writes its
+ events as a Chrome trace JSON file that can be loaded into
+ chrome://tracing or https://ui.perfetto.dev.  Timestamps are relative to an
+ epoch taken right after a barrier, so the per-rank files line up on a
+ common time axis.
+
+ Tracing is switched on by setting the environment variable \c MAD_TRACE to
+ a file prefix before calling \c madness::initialize; the traces are then
+ written to <tt>prefix.<rank>.json</tt> by \c madness::finalize.  The ring
+ size (events per thread) can be set with \c MAD_TRACE_BUFFER.
+*/
+
+#include <madness/world/timers.h>
+#include <atomic>
+#include <cstddef>
+#include <string>
+
+namespace madness {
+
+    class World;
+
+    namespace tracing {
+
+        /// Category of a recorded event
+        enum class EventKind : unsigned char {
+            task,       ///< a task run by the thread pool
+            am,         ///< an active message handler run by the RMI server
+            fence,      ///< a global fence
+            macrotask,  ///< a macrotask run in a subworld
+            user,       ///< a user-defined span
+            counter     ///< a sampled counter value
+        };
+
+        /// How the \c id of an event is to be interpreted when exporting
+        enum IdKind : unsigned short {
+            id_string = 0,      ///< \c id is a null-terminated string with static lifetime
+            id_function = 1,    ///< \c id is a function pointer, resolved with backtrace_symbols
+            id_typename = 2     ///< \c id is a mangled type name (same convention as \c PoolTaskInterface::get_id)
+        };
+
+        /// A single trace record
+        struct Event {
+            double start;           ///< wall_time() at the start of the span or of the sample
+            double value;           ///< duration of a span, or value of a counter
+            const void* id;         ///< identification, see \c IdKind
+            unsigned short idkind;  ///< interpretation of \c id
+            EventKind kind;         ///< category of the event
+        };
+
+        /// Process-wide tracing control and per-thread event storage
+        class Tracer {
+            static std::atomic<bool> enabled_;
+
+        public:
+
+            /// True if events are being recorded
+
+            /// This is the only check performed on the fast path of the
+            /// instrumented code when tracing is off.
+            static bool enabled() {
+                return enabled_.load(std::memory_order_relaxed);
+            }
+
+            /// Start recording
+
+            /// \param[in] capacity Number of events kept per thread (only affects buffers allocated later)
+            /// \param[in] epoch wall_time() at a point common to all ranks (e.g. right after a barrier)
+            static void enable(std::size_t capacity, double epoch);
+
+            /// Stop recording; recorded events are kept
+            static void disable();
+
+            /// Discard all recorded events
+
+            /// Must only be called when no other thread is recording, e.g. after a fence.
+            static void clear();
+
+            /// Number of events currently held on this process
+            static std::size_t size();
+
+            /// Record a completed span
+            static void record_span(EventKind kind, double start, double stop,
+                                    const void* id, unsigned short idkind);
+
+            /// Record a completed span with a static name
+            static void record_span(EventKind kind, double start, double stop, const char* name) {
+                record_span(kind, start, stop, name, id_string);
+            }
+
+            /// Record a counter sample
+
+            /// \param[in] name Counter name, must have static lifetime
+            /// \param[in] value Current value of the counter
+            static void record_counter(const char* name, double value);
+
+            /// Write the events of this process in Chrome trace format to <tt>prefix.<rank>.json</tt>
+
+            /// Fences \c world first so that no thread is recording while the
+            /// buffers are read.  Collective on \c world.
+            static void write_chrome_trace(World& world, const std::string& prefix);
+
+            /// Write the events of this process in Chrome trace format to \c filename
+
+            /// Not collective; no thread may record while the buffers are read.
+            /// \param[in] rank Used as the Chrome trace process id
+            static void write_chrome_trace(const std::string& filename, int rank);
+        };
+
+        /// Records a span from construction to destruction if tracing is enabled
+
+        /// \code
+        ///    {
+        ///        tracing::Span s("diagonalize");
+        ///        ...
+        ///    }
+        /// \endcode
+        class Span {
+            const char* name;
+            double start;
+            EventKind kind;
+        public:
+            explicit Span(const char* name, EventKind kind=EventKind::user)
+                : name(name), start(Tracer::enabled() ? wall_time() : -1.0), kind(kind) {}
+
+            ~Span() {
+                if (start >= 0.0) Tracer::record_span(kind, start, wall_time(), name);
+            }
+
+            Span(const Span&) = delete;
+            Span& operator=(const Span&) = delete;
+        };
+
+    } // namespace tracing
+} // namespace madness
+
+#endif // MADNESS_WORLD_WORLDTRACE_H__INCLUDED